@@ -1,4 +1,4 @@
-/* Results:
+/* Results (measured with the earlier 1 ms retry delay driver):
  * ----------------------------------------
  * TWI@100kHz
  * ----------------------------------------
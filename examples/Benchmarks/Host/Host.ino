@@ -0,0 +1,216 @@
+/*
+ * Benchmark of storage access paths on device timing models. The
+ * devices are simulated with a memory buffer and a bus cost model
+ * (AT24CXX 400 kHz, 23LC512 8 MHz). The time is the simulated time
+ * and is deterministic; the benchmark may be run on the host or on
+ * a board with enough memory (e.g. Mega).
+ *
+ * Output is one CSV line per benchmark with the measured and the
+ * baseline time, and the change in percent. Changes above the
+ * threshold are reported as regressions. Define PRINT_BASELINE to
+ * print a new baseline.h.
+ *
+ * Host build and run: make -C extras/host bench (new baseline.h:
+ * make -C extras/host baseline).
+ *
+ * Benchmarks:
+ * read/write: Block read/write N bytes.
+ * page: Block write of a page (32 bytes) at offset N in page.
+ * cache-read/cache-write: Cache read/write of N members (8 bytes).
+ * cache-iter: Cache::Iterator scan of N members (16 per chunk).
+ * cache-ahead: ReadAheadCache read of N members (16 read-ahead).
+ * stream-byte: Stream write and read of N bytes, one at a time.
+ * stream-bulk: Stream write and read of N bytes in one call.
+ * stream-buffered: Buffered Stream (32 bytes) byte write and read.
+ */
+
+#include "Storage.h"
+#include "Driver/RAM.h"
+#include "Driver/Model.h"
+
+// Configure: print new baseline.h instead of comparison
+// #define PRINT_BASELINE
+
+// Regression threshold in percent
+const int THRESHOLD = 5;
+
+// Baseline times (us) in benchmark order
+#include "baseline.h"
+
+// Simulated device memory
+const size_t MEM_MAX = 2048;
+static uint8_t mem[MEM_MAX];
+RAM ram(mem, sizeof(mem));
+
+// Device timing models; AT24CXX driver polls every 100 us
+AT24CXXModel eeprom(ram, 400000UL, 32, 5000, 100);
+MC23LCXXXModel sram(ram);
+
+// Local memory buffer
+const int BUF_MAX = 1000;
+static uint8_t buf[BUF_MAX];
+
+// Cache member and chunk buffer
+struct member_t {
+  uint32_t timestamp;
+  uint16_t value;
+  uint16_t status;
+};
+const size_t MEMBER_MAX = 100;
+const size_t CHUNK_MAX = 16;
+static member_t chunk[CHUNK_MAX];
+
+// Benchmark index and number of regressions
+static size_t ix = 0;
+static int regressions = 0;
+
+void report(const char* name, Model& model, const char* dev, uint32_t n)
+{
+  uint32_t us = model.elapsed();
+  uint32_t base = 0;
+  if (ix < BASELINE_MAX) base = pgm_read_dword(&baseline[ix]);
+  ix += 1;
+
+#if defined(PRINT_BASELINE)
+  Serial.print(F("  "));
+  Serial.print(us);
+  Serial.print(F(", // "));
+  Serial.print(name);
+  Serial.print(F(", "));
+  Serial.print(dev);
+  Serial.print(F(", "));
+  Serial.println(n);
+#else
+  Serial.print(name);
+  Serial.print(F(", "));
+  Serial.print(dev);
+  Serial.print(F(", "));
+  Serial.print(n);
+  Serial.print(F(", "));
+  Serial.print(us);
+  Serial.print(F(", "));
+  Serial.print(base);
+  Serial.print(F(", "));
+  if (base == 0) {
+    Serial.println(F("0, new"));
+    return;
+  }
+  int32_t delta = (((int32_t) us - (int32_t) base) * 100L) / (int32_t) base;
+  Serial.print(delta);
+  if (delta > THRESHOLD) {
+    Serial.println(F(", regression"));
+    regressions += 1;
+  }
+  else {
+    Serial.println(F(", ok"));
+  }
+#endif
+}
+
+void benchmark(Model& model, const char* dev)
+{
+  // Benchmark#1: Measure block write with increasing buffer size
+  {
+    Storage::Block block(model, BUF_MAX);
+    for (uint32_t n = 1; n <= 1000; n *= 10) {
+      model.reset();
+      block.write(0, buf, n);
+      report("write", model, dev, n);
+    }
+
+    // Benchmark#2: Measure block read with increasing buffer size
+    for (uint32_t n = 1; n <= 1000; n *= 10) {
+      model.reset();
+      block.read(buf, 0, n);
+      report("read", model, dev, n);
+    }
+
+    // Benchmark#3: Measure block page write at offset in page
+    static const uint8_t offset[] = { 0, 1, 16, 31 };
+    for (uint8_t i = 0; i < sizeof(offset); i++) {
+      model.reset();
+      block.write(offset[i], buf, 32);
+      report("page", model, dev, offset[i]);
+    }
+  }
+
+  // Benchmark#4: Measure cache member write, read and scan
+  member_t member;
+  Storage::Cache cache(model, &member, sizeof(member), MEMBER_MAX);
+  model.reset();
+  for (size_t i = 0; i < MEMBER_MAX; i++) {
+    member.timestamp = i;
+    cache.write(i);
+  }
+  report("cache-write", model, dev, MEMBER_MAX);
+  model.reset();
+  for (size_t i = 0; i < MEMBER_MAX; i++) cache.read(i);
+  report("cache-read", model, dev, MEMBER_MAX);
+  model.reset();
+  Storage::Cache::Iterator iter(cache, chunk, CHUNK_MAX);
+  while (iter.next());
+  report("cache-iter", model, dev, MEMBER_MAX);
+  {
+    Storage::ReadAheadCache ahead(model, &member, chunk, CHUNK_MAX,
+				  sizeof(member), MEMBER_MAX);
+    model.reset();
+    for (size_t i = 0; i < MEMBER_MAX; i++) ahead.read(i);
+    report("cache-ahead", model, dev, MEMBER_MAX);
+  }
+
+  // Benchmark#5: Measure stream byte and bulk write and read
+  const size_t STREAM_MAX = 100;
+  {
+    Storage::Stream stream(model, STREAM_MAX);
+    model.reset();
+    for (size_t i = 0; i < STREAM_MAX; i++) stream.write(buf[i]);
+    for (size_t i = 0; i < STREAM_MAX; i++) stream.read();
+    report("stream-byte", model, dev, STREAM_MAX);
+    model.reset();
+    stream.write(buf, STREAM_MAX);
+    stream.read(buf, STREAM_MAX);
+    report("stream-bulk", model, dev, STREAM_MAX);
+  }
+  {
+    uint8_t put[32];
+    uint8_t get[32];
+    Storage::Stream stream(model, STREAM_MAX, put, get, sizeof(put));
+    model.reset();
+    for (size_t i = 0; i < STREAM_MAX; i++) stream.write(buf[i]);
+    for (size_t i = 0; i < STREAM_MAX; i++) stream.read();
+    report("stream-buffered", model, dev, STREAM_MAX);
+  }
+}
+
+void setup()
+{
+  Serial.begin(57600);
+  while (!Serial);
+
+  for (int i = 0; i < BUF_MAX; i++) buf[i] = i;
+
+#if defined(PRINT_BASELINE)
+  Serial.println(F("/*"));
+  Serial.println(F(" * Benchmark baseline; simulated time (us) per "
+		   "benchmark in order."));
+  Serial.println(F(" * Generated with PRINT_BASELINE defined."));
+  Serial.println(F(" */"));
+  Serial.println(F("static const uint32_t baseline[] PROGMEM = {"));
+#else
+  Serial.println(F("name, device, n, us, baseline, delta(%), status"));
+#endif
+  benchmark(eeprom, "AT24CXX");
+  benchmark(sram, "23LC512");
+#if defined(PRINT_BASELINE)
+  Serial.println(F("};"));
+  Serial.println(F("const size_t BASELINE_MAX = "
+		   "sizeof(baseline) / sizeof(baseline[0]);"));
+#else
+  Serial.print(F("regressions, "));
+  Serial.println(regressions);
+#endif
+}
+
+void loop()
+{
+}
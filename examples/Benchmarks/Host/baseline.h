@@ -0,0 +1,45 @@
+/*
+ * Benchmark baseline; simulated time (us) per benchmark in order.
+ * Generated with PRINT_BASELINE defined.
+ */
+static const uint32_t baseline[] PROGMEM = {
+  140, // write, AT24CXX, 1
+  342, // write, AT24CXX, 10
+  17727, // write, AT24CXX, 100
+  181337, // write, AT24CXX, 1000
+  162, // read, AT24CXX, 1
+  365, // read, AT24CXX, 10
+  2390, // read, AT24CXX, 100
+  22640, // read, AT24CXX, 1000
+  837, // page, AT24CXX, 0
+  5957, // page, AT24CXX, 1
+  5957, // page, AT24CXX, 16
+  5957, // page, AT24CXX, 31
+  524997, // cache-write, AT24CXX, 100
+  32000, // cache-read, AT24CXX, 100
+  18980, // cache-iter, AT24CXX, 100
+  19260, // cache-ahead, AT24CXX, 100
+  530500, // stream-byte, AT24CXX, 100
+  25120, // stream-bulk, AT24CXX, 100
+  25540, // stream-buffered, AT24CXX, 100
+  20, // write, 23LC512, 1
+  29, // write, 23LC512, 10
+  119, // write, 23LC512, 100
+  1019, // write, 23LC512, 1000
+  20, // read, 23LC512, 1
+  29, // read, 23LC512, 10
+  119, // read, 23LC512, 100
+  1019, // read, 23LC512, 1000
+  51, // page, 23LC512, 0
+  51, // page, 23LC512, 1
+  51, // page, 23LC512, 16
+  51, // page, 23LC512, 31
+  2700, // cache-write, 23LC512, 100
+  2700, // cache-read, 23LC512, 100
+  933, // cache-iter, 23LC512, 100
+  971, // cache-ahead, 23LC512, 100
+  4000, // stream-byte, 23LC512, 100
+  238, // stream-bulk, 23LC512, 100
+  352, // stream-buffered, 23LC512, 100
+};
+const size_t BASELINE_MAX = sizeof(baseline) / sizeof(baseline[0]);
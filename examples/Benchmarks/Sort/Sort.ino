@@ -0,0 +1,100 @@
+/*
+ * Benchmark of the external merge sort (Storage::Cache::Sort) on
+ * device timing models. The devices are simulated with a memory
+ * buffer and a bus cost model (AT24CXX 400 kHz, 23LC512 8 MHz). The
+ * time is the simulated time and is deterministic; the benchmark may
+ * be run on the host or on a board with enough memory (e.g. Mega).
+ *
+ * Output is one CSV line per device and work buffer size with the
+ * number of members, passes, bytes transferred, time and if the
+ * result was verified as sorted.
+ */
+
+#include "Storage.h"
+#include "Driver/RAM.h"
+#include "Driver/Model.h"
+
+// Simulated device memory; members and scratch block
+const size_t MEM_MAX = 4096;
+static uint8_t mem[MEM_MAX];
+RAM ram(mem, sizeof(mem));
+
+// Device timing models; AT24CXX driver polls every 100 us
+AT24CXXModel eeprom(ram, 400000UL, 32, 5000, 100);
+MC23LCXXXModel sram(ram);
+
+// Sample member; sorted on value
+struct sample_t {
+  uint32_t timestamp;
+  uint16_t value;
+};
+const size_t SAMPLE_MAX = 200;
+
+// Local memory work buffer
+const size_t BUF_MAX = 512;
+static uint8_t buf[BUF_MAX];
+
+int compare(const void* a, const void* b)
+{
+  uint16_t x = ((const sample_t*) a)->value;
+  uint16_t y = ((const sample_t*) b)->value;
+  return ((x > y) - (x < y));
+}
+
+void benchmark(Model& model, const char* dev)
+{
+  sample_t sample;
+  Storage::Cache samples(model, &sample, sizeof(sample), SAMPLE_MAX);
+  for (size_t size = 64; size <= BUF_MAX; size *= 2) {
+    // Write pseudo-random samples
+    randomSeed(42);
+    for (size_t i = 0; i < SAMPLE_MAX; i++) {
+      sample.timestamp = i;
+      sample.value = random(1000);
+      samples.write(i);
+    }
+
+    // Sort with given work buffer size
+    Storage::Cache::Sort sort(samples, buf, size, compare);
+    model.reset();
+    int passes = sort.run();
+    uint32_t us = model.elapsed();
+
+    // Verify order
+    bool sorted = (passes > 0);
+    uint16_t last = 0;
+    for (size_t i = 0; sorted && (i < SAMPLE_MAX); i++) {
+      samples.read(i);
+      sorted = (sample.value >= last);
+      last = sample.value;
+    }
+
+    Serial.print(dev);
+    Serial.print(F(", "));
+    Serial.print(SAMPLE_MAX);
+    Serial.print(F(", "));
+    Serial.print(size);
+    Serial.print(F(", "));
+    Serial.print(passes);
+    Serial.print(F(", "));
+    Serial.print(sort.bytes());
+    Serial.print(F(", "));
+    Serial.print(us);
+    Serial.print(F(", "));
+    Serial.println(sorted ? F("ok") : F("fail"));
+  }
+}
+
+void setup()
+{
+  Serial.begin(57600);
+  while (!Serial);
+
+  Serial.println(F("device, n, buffer, passes, bytes, us, status"));
+  benchmark(eeprom, "AT24CXX");
+  benchmark(sram, "23LC512");
+}
+
+void loop()
+{
+}
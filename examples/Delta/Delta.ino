@@ -0,0 +1,94 @@
+#include "Storage.h"
+#include "Delta.h"
+#include "GPIO.h"
+#include "SPI.h"
+#include "Driver/MC23LC1024.h"
+
+// Configure: SPI bus manager variant
+// #define USE_SOFTWARE_SPI
+#define USE_HARDWARE_SPI
+
+#if defined(USE_SOFTWARE_SPI)
+#include "Software/SPI.h"
+Software::SPI<BOARD::D11, BOARD::D12, BOARD::D13> spi;
+#elif defined(USE_HARDWARE_SPI)
+#include "Hardware/SPI.h"
+Hardware::SPI spi;
+#endif
+
+// External memory storage (128 Kbyte)
+MC23LC1024<BOARD::D10> sram(spi);
+
+// Configure: Run-length mode
+// #define USE_RLE
+#if defined(USE_RLE)
+const bool RLE = true;
+#else
+const bool RLE = false;
+#endif
+
+// Sample stream (60 Kbyte); raw sample is timestamp and value, 6 bytes
+const size_t STREAM_MAX = 60000;
+const size_t SAMPLE_SIZE = 6;
+Storage::Stream samples(sram, STREAM_MAX);
+
+void setup()
+{
+  Serial.begin(57600);
+  while (!Serial);
+}
+
+void loop()
+{
+  // Sample analog values with timestamp until the stream is full
+  DeltaEncoder<2> encoder(samples, RLE);
+  int32_t sample[2];
+  uint32_t start = micros();
+  while (1) {
+    sample[0] = micros();
+    sample[1] = analogRead(A0);
+    if (encoder.write(sample) < 0) break;
+  }
+  if (encoder.flush() < 0) {
+    Serial.println(F("flush: failed"));
+    Serial.flush();
+    delay(5000);
+    return;
+  }
+  uint32_t us = micros() - start;
+
+  // Decode samples and calculate min, max and sum
+  DeltaDecoder<2> decoder(samples, RLE);
+  int32_t min = INT16_MAX;
+  int32_t max = 0;
+  uint32_t sum = 0;
+  uint32_t count = 0;
+  while (decoder.read(sample)) {
+    if (sample[1] < min) min = sample[1];
+    if (sample[1] > max) max = sample[1];
+    sum += sample[1];
+    count += 1;
+  }
+
+  // Print the results; samples, compression ratio, min, max and average
+  Serial.println();
+  Serial.print(F("samples = "));
+  Serial.println(encoder.count());
+  Serial.print(F("bytes = "));
+  Serial.println(encoder.length());
+  Serial.print(F("ratio = "));
+  Serial.println((float) (encoder.count() * SAMPLE_SIZE) / encoder.length());
+  Serial.print(F("us/sample = "));
+  Serial.println(us / encoder.count());
+  Serial.print(F("decoded = "));
+  Serial.println(count);
+  Serial.print(F("min = "));
+  Serial.println(min);
+  Serial.print(F("max = "));
+  Serial.println(max);
+  Serial.print(F("avg = "));
+  Serial.println((float) sum / count);
+  Serial.flush();
+
+  delay(5000);
+}
@@ -1,4 +1,5 @@
 #include "Storage.h"
+#include "Journal.h"
 #include "Driver/EEPROM.h"
 
 // Use internal eeprom for configuration storage
@@ -11,16 +12,10 @@ struct config_t {
   uint8_t mac[6];
 };
 
-// Macro to enforce naming convention
-#define PERSISTENT(v) persistent_ ## v
-
-// Reset to default configuration flag
-bool reset;
-Storage::Cache PERSISTENT(reset)(eeprom, &reset, sizeof(reset));
-
-// Persistent configuration
+// Persistent configuration; journal with 8 copies (wear-leveling)
 config_t config;
-Storage::Cache PERSISTENT(config)(eeprom, &config, sizeof(config));
+const size_t COPY_MAX = 8;
+Journal persistent(eeprom, &config, sizeof(config), COPY_MAX);
 
 // Default configuration
 static const char ssid[] PROGMEM = "Wi-Fi SSID";
@@ -31,27 +26,17 @@ void setup()
   Serial.begin(57600);
   while (!Serial);
 
-  // Check the reset flag; write default configuration or read persistent
-  PERSISTENT(reset).read();
-  if (reset) {
+  // Read newest valid configuration or write default configuration
+  if (persistent.read() < 0) {
     Serial.println(F("Write default configuration"));
-    config.timestamp = 0;
+    memset(&config, 0, sizeof(config));
     strcat_P(config.ssid, ssid);
     memcpy_P(config.mac, mac, sizeof(mac));
-    PERSISTENT(config).write();
-    reset = false;
-    PERSISTENT(reset).write();
+    persistent.write();
   }
   else {
     Serial.println(F("Read configuration"));
-    PERSISTENT(config).read();
   }
-
-  Serial.print(millis() / 1000.0);
-  Serial.print(F(":reset@"));
-  Serial.print(PERSISTENT(reset).addr());
-  Serial.print(F(" = "));
-  Serial.println(reset);
 }
 
 void loop()
@@ -62,8 +47,12 @@ void loop()
   // Print configuration
   Serial.print(start / 1000.0);
   Serial.print(F(":config@"));
-  Serial.print(PERSISTENT(config).addr());
-  Serial.print(F(": timestamp = "));
+  Serial.print(persistent.addr());
+  Serial.print(F("["));
+  Serial.print(persistent.slot());
+  Serial.print(F("]: seq = "));
+  Serial.print(persistent.seq());
+  Serial.print(F(", timestamp = "));
   Serial.print(config.timestamp);
   Serial.print(F(", ssid = \""));
   Serial.print(config.ssid);
@@ -79,10 +68,8 @@ void loop()
   if (++n < 60) return;
   n = 0;
 
-  // Update timestamp every minute and write to eeprom
+  // Update timestamp every minute and append to journal
   Serial.println(F("Update timestamp"));
   config.timestamp++;
-  PERSISTENT(config).Block::write(offsetof(config_t, timestamp),
-				  &config.timestamp,
-				  sizeof(config.timestamp));
+  persistent.write();
 }
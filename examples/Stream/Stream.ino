@@ -17,9 +17,20 @@ Hardware::SPI spi;
 // External memory storage
 MC23LC1024<BOARD::D10> sram(spi);
 
+// Configure: Local put/get buffers for streams
+// #define USE_BUFFERED_STREAM
+
 // Storage streams; 10000 bytes each
+#if defined(USE_BUFFERED_STREAM)
+const size_t BUF_MAX = 32;
+uint8_t ios_put[BUF_MAX], ios_get[BUF_MAX];
+uint8_t temps_put[BUF_MAX], temps_get[BUF_MAX];
+Storage::Stream ios(sram, 10000, ios_put, ios_get, BUF_MAX);
+Storage::Stream temps(sram, 10000, temps_put, temps_get, BUF_MAX);
+#else
 Storage::Stream ios(sram, 10000);
 Storage::Stream temps(sram, 10000);
+#endif
 
 // Sample size and performance measurements
 const int N = 1000;
@@ -58,11 +69,11 @@ void loop()
   ios.println();
   m1 = micros() - s0;
 
-  // Transfer data between two sram streams
+  // Transfer data between two sram streams (bulk, 32 byte chunks)
+  uint8_t buf[32];
   count = ios.available();
   s0 = micros();
-  while (ios.available())
-    temps.write(ios.read());
+  temps.transfer(ios, buf, sizeof(buf));
   m2 = micros() - s0;
 
   // Print data from sram stream to serial stream
@@ -117,7 +128,7 @@ void loop()
   Serial.println();
   Serial.print(F("SRAM::Stream.available, count = "));
   Serial.println(count);
-  Serial.print(F("SRAM::Stream.write/read, m2 = "));
+  Serial.print(F("SRAM::Stream.transfer, m2 = "));
   Serial.println(m2 / count);
   Serial.print(F("SRAM::Stream.read/Serial.write, m3 = "));
   Serial.println(m3 / count);
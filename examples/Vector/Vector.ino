@@ -45,6 +45,18 @@ sample_t sample;
 const size_t NMEMB = 10000;
 Storage::Cache vector(sram, &sample, sizeof(sample), NMEMB);
 
+// Chunk buffer for scanning the vector (32 members per transaction)
+const size_t CHUNK_MAX = 32;
+sample_t chunk[CHUNK_MAX];
+
+// Configure: Double-buffered capture (32 members per transaction)
+// #define USE_CAPTURE
+
+#if defined(USE_CAPTURE)
+const size_t DEPTH = 32;
+sample_t buffers[2 * DEPTH];
+#endif
+
 void setup()
 {
   Serial.begin(57600);
@@ -65,18 +77,35 @@ void setup()
 void loop()
 {
   // Sample analog values, timestamp and write to storage
+#if defined(USE_CAPTURE)
+  // Write remaining partial buffer with flush() and check for
+  // dropped samples (both buffers full)
+  Storage::Cache::Capture capture(vector, buffers, DEPTH);
+  for (size_t i = 0; i < vector.NMEMB; i++) {
+    sample.timestamp = micros();
+    sample.value = analogRead(A0);
+    capture.put(&sample);
+    capture.pump();
+  }
+  if (capture.flush() < 0) Serial.println(F("capture: flush failed"));
+  Serial.print(F("capture.count = "));
+  Serial.println(capture.count());
+  Serial.print(F("capture.overflows = "));
+  Serial.println(capture.overflows());
+#else
   for (size_t i = 0; i < vector.NMEMB; i++) {
     sample.timestamp = micros();
     sample.value = analogRead(A0);
     vector.write(i);
   }
+#endif
 
-  // Read back samples and calculate min, max and sum
+  // Read back samples (in chunks) and calculate min, max and sum
   uint16_t min = UINT16_MAX;
   uint16_t max = 0;
   uint64_t sum = 0;
-  for (size_t i = 0; i < vector.NMEMB; i++) {
-    vector.read(i);
+  Storage::Cache::Iterator iter(vector, chunk, CHUNK_MAX);
+  while (iter.next()) {
     if (sample.value < min) min = sample.value;
     if (sample.value > max) max = sample.value;
     sum += sample.value;
@@ -0,0 +1,175 @@
+/**
+ * @file Arduino.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * Minimal Arduino core for host builds of the library with the
+ * memory drivers (RAM, MMAP) and the device timing models. Only the
+ * subset used by the library, the host benchmarks and the checks
+ * is provided. Program memory is ordinary memory, interrupts are
+ * never taken and println() ends lines with a newline only.
+ */
+
+#define PROGMEM
+#define F(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t*) (p))
+#define pgm_read_word(p) (*(const uint16_t*) (p))
+#define pgm_read_dword(p) (*(const uint32_t*) (p))
+#define memcpy_P memcpy
+#define strcat_P strcat
+#define MSBFIRST 1
+#define A0 0
+
+/** Status register; interrupt flag save/restore is a no-op. */
+static uint8_t SREG = 0;
+inline void noInterrupts() { (void) SREG; }
+inline void interrupts() {}
+
+/**
+ * Returns microseconds since an arbitrary start (monotonic clock).
+ * @return microseconds.
+ */
+inline uint32_t micros()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint32_t) ((ts.tv_sec * 1000000ULL) + (ts.tv_nsec / 1000)));
+}
+
+/**
+ * Returns milliseconds since an arbitrary start (monotonic clock).
+ * @return milliseconds.
+ */
+inline uint32_t millis()
+{
+  return (micros() / 1000);
+}
+
+inline void delayMicroseconds(unsigned int us)
+{
+  uint32_t start = micros();
+  while (micros() - start < us);
+}
+
+inline void delay(unsigned long ms)
+{
+  (void) ms;
+}
+
+inline int analogRead(uint8_t pin)
+{
+  (void) pin;
+  return (rand() & 0x3ff);
+}
+
+inline void randomSeed(unsigned long seed)
+{
+  srand(seed);
+}
+
+inline long random(long max)
+{
+  return (rand() % max);
+}
+
+/**
+ * Print; formatted output of strings and numbers to a byte sink.
+ */
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t byte) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size)
+  {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return (n);
+  }
+  size_t write(const char* s) { return (write((const uint8_t*) s, strlen(s))); }
+  size_t print(const char* s) { return (write(s)); }
+  size_t print(char c) { return (write((uint8_t) c)); }
+  size_t print(int value) { return (print((long) value)); }
+  size_t print(unsigned int value) { return (print((unsigned long) value)); }
+  size_t print(long value) { return (format("%ld", value)); }
+  size_t print(unsigned long value) { return (format("%lu", value)); }
+  size_t print(long long value) { return (format("%lld", value)); }
+  size_t print(unsigned long long value) { return (format("%llu", value)); }
+  size_t print(double value, int digits = 2) { return (format("%.*f", digits, value)); }
+  size_t println() { return (write("\n")); }
+  template<typename T> size_t println(T value) { return (print(value) + println()); }
+
+protected:
+  template<typename... Args> size_t format(const char* fmt, Args... args)
+  {
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), fmt, args...);
+    return (write((const uint8_t*) buf, n));
+  }
+};
+
+/**
+ * Stream; byte source and sink.
+ */
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush() {}
+  size_t readBytes(char* buffer, size_t length)
+  {
+    size_t n = 0;
+    while (n < length) {
+      int c = read();
+      if (c < 0) break;
+      buffer[n++] = c;
+    }
+    return (n);
+  }
+  size_t readBytes(uint8_t* buffer, size_t length)
+  {
+    return (readBytes((char*) buffer, length));
+  }
+};
+
+/**
+ * Serial; output to stdout, no input.
+ */
+class HostSerial : public Stream {
+public:
+  void begin(unsigned long baudrate) { (void) baudrate; }
+  operator bool() { return (true); }
+  using Print::write;
+  virtual size_t write(uint8_t byte) { return (putchar(byte) == EOF ? 0 : 1); }
+  virtual int available() { return (0); }
+  virtual int read() { return (-1); }
+  virtual int peek() { return (-1); }
+  virtual void flush() { fflush(stdout); }
+};
+
+extern HostSerial Serial;
+#endif
@@ -0,0 +1,35 @@
+/**
+ * @file main.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#include "Arduino.h"
+
+HostSerial Serial;
+
+void setup();
+void loop();
+
+/**
+ * Run sketch on host; setup() and a single loop() call.
+ */
+int main()
+{
+  setup();
+  loop();
+  Serial.flush();
+  return (0);
+}
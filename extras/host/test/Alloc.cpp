@@ -0,0 +1,122 @@
+/**
+ * @file Alloc.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Storage allocator; random alloc and free order. Allocated blocks
+ * must not overlap and room, leaked and allocated bytes must add up
+ * to the device size. Short-lived blocks and streams freed out of
+ * order are reclaimed. Built with the default free extent table and
+ * without (STORAGE_FREE_MAX zero).
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Driver/RAM.h"
+
+static uint8_t mem[4096];
+
+struct block_t {
+  uint32_t addr;
+  uint32_t size;
+};
+
+const size_t BLOCK_MAX = 64;
+
+void check_alloc(unsigned seed)
+{
+  block_t live[BLOCK_MAX];
+  size_t n = 0;
+  srand(seed);
+  RAM ram(mem, sizeof(mem));
+  for (int i = 0; i < 500; i++) {
+    if ((n == 0) || ((n < BLOCK_MAX) && (rand() & 1))) {
+      uint32_t size = 1 + rand() % 200;
+      uint32_t addr = ram.alloc(size);
+      if (addr == UINT32_MAX) {
+	CHECK(ram.largest() < size);
+	continue;
+      }
+      CHECK(addr + size <= sizeof(mem));
+      for (size_t j = 0; j < n; j++)
+	CHECK((addr + size <= live[j].addr)
+	      || (live[j].addr + live[j].size <= addr));
+      live[n].addr = addr;
+      live[n].size = size;
+      n += 1;
+    }
+    else {
+      size_t j = rand() % n;
+      ram.free(live[j].addr, live[j].size);
+      live[j] = live[--n];
+    }
+    uint32_t used = 0;
+    for (size_t j = 0; j < n; j++) used += live[j].size;
+    CHECK(ram.room() + ram.leaked() + used == sizeof(mem));
+  }
+  while (n > 0) {
+    n -= 1;
+    ram.free(live[n].addr, live[n].size);
+  }
+  CHECK(ram.room() + ram.leaked() == sizeof(mem));
+  if (ram.leaked() == 0) CHECK(ram.fragments() == 0);
+}
+
+void check_lifo()
+{
+  RAM ram(mem, sizeof(mem));
+  {
+    Storage::Block a(ram, 100);
+    Storage::Block b(ram, 200);
+    CHECK(b.addr() == a.addr() + a.SIZE);
+    CHECK(ram.room() == sizeof(mem) - 300);
+  }
+  CHECK(ram.room() == sizeof(mem));
+  CHECK(ram.leaked() == 0);
+}
+
+void check_out_of_order()
+{
+  RAM ram(mem, sizeof(mem));
+  for (int i = 0; i < 1000; i++) {
+    Storage::Block* a = new Storage::Block(ram, 100);
+    Storage::Stream* s = new Storage::Stream(ram, 200);
+    Storage::Block* b = new Storage::Block(ram, 50);
+    delete a;
+    delete s;
+    delete b;
+  }
+#if STORAGE_FREE_MAX > 0
+  CHECK(ram.room() == sizeof(mem));
+  CHECK(ram.leaked() == 0);
+#else
+  CHECK(ram.room() + ram.leaked() == sizeof(mem));
+#endif
+}
+
+int main()
+{
+  for (unsigned seed = 1; seed < 200; seed++) check_alloc(seed);
+  check_lifo();
+  check_out_of_order();
+#if STORAGE_FREE_MAX > 0
+  static const char name[] = "Alloc";
+#else
+  static const char name[] = "Alloc (no free extent table)";
+#endif
+  return (check_report(name));
+}
@@ -0,0 +1,120 @@
+/**
+ * @file Async.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Async request queue; submit, pump, completion callbacks and
+ * queue full. AsyncThread with concurrent submit and wait, also
+ * through a queue reference (build with ThreadSanitizer).
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Async.h"
+#include "Driver/RAM.h"
+#include "Driver/Model.h"
+#include "Driver/AsyncThread.h"
+
+static uint8_t mem[4096];
+static int completed = 0;
+
+void callback(Async::Request& req)
+{
+  completed += 1;
+  *(int*) req.env += req.res;
+}
+
+int main()
+{
+  RAM ram(mem, sizeof(mem));
+  AT24CXXModel eeprom(ram);
+  uint8_t buf[64];
+  uint8_t res[64];
+  int total = 0;
+  memset(buf, 7, sizeof(buf));
+
+  // Queue on device timing model
+  Async::Queue<4> queue(eeprom);
+  Async::Request req[6];
+  for (int i = 0; i < 6; i++) {
+    req[i].callback = callback;
+    req[i].env = &total;
+  }
+  for (int i = 0; i < 4; i++) CHECK(queue.write(req[i], i * 64, buf, 64) == 0);
+  CHECK(queue.write(req[4], 256, buf, 64) < 0);
+  CHECK(queue.read(req[0], res, 0, 64) < 0);
+  CHECK(queue.available() == 4);
+  CHECK(queue.room() == 0);
+  queue.flush();
+  CHECK(completed == 4);
+  CHECK(total == 256);
+  CHECK(queue.available() == 0);
+  CHECK(queue.read(req[0], res, 64, 64) == 0);
+  CHECK(queue.wait(req[0]) == 64);
+  CHECK(memcmp(res, buf, sizeof(buf)) == 0);
+  CHECK(!queue.pump());
+
+  // Worker thread; 8000 requests with reuse of completed requests
+  {
+    AsyncThread<8> thread(ram);
+    Async::Request rr[8];
+    total = 0;
+    completed = 0;
+    for (int i = 0; i < 8; i++) {
+      rr[i].callback = callback;
+      rr[i].env = &total;
+    }
+    for (int k = 0; k < 1000; k++) {
+      for (int i = 0; i < 8; i++) {
+	while (thread.write(rr[i], i * 64, buf, 64) < 0) thread.wait(rr[i]);
+      }
+    }
+    thread.flush();
+    CHECK(completed == 8000);
+    CHECK(total == 8000 * 64);
+    CHECK(thread.read(rr[0], res, 0, 64) == 0);
+    CHECK(thread.wait(rr[0]) == 64);
+  }
+
+  // Worker thread through queue reference; submit under the lock and
+  // no pump on the caller thread
+  {
+    AsyncThread<8> thread(ram);
+    Async::Queue<8>& queue = thread;
+    Async::Request rr[8];
+    total = 0;
+    completed = 0;
+    for (int i = 0; i < 8; i++) {
+      rr[i].callback = callback;
+      rr[i].env = &total;
+    }
+    for (int k = 0; k < 1000; k++) {
+      for (int i = 0; i < 8; i++) {
+	while (queue.write(rr[i], i * 64, buf, 64) < 0) queue.wait(rr[i]);
+      }
+      CHECK(!queue.pump());
+    }
+    queue.flush();
+    CHECK(completed == 8000);
+    CHECK(total == 8000 * 64);
+    CHECK(queue.available() == 0);
+    CHECK(queue.read(rr[0], res, 0, 64) == 0);
+    CHECK(queue.wait(rr[0]) == 64);
+  }
+
+  return (check_report("Async"));
+}
@@ -0,0 +1,195 @@
+/**
+ * @file Cache.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Cache variants; SlotCache and ShadowCache on device timing models.
+ * Contents are compared with a reference in host memory. Iterator,
+ * Capture and Sort on the cache variants by reference.
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Driver/RAM.h"
+#include "Driver/Model.h"
+
+static uint8_t mem[131072];
+
+struct sample_t {
+  uint32_t timestamp;
+  uint16_t value;
+};
+
+const size_t NMEMB = 1000;
+static sample_t ref[NMEMB];
+
+void check_slot_cache(Storage& dev)
+{
+  sample_t sample;
+  sample_t slots[4];
+  {
+    Storage::SlotCache<4> cache(dev, &sample, slots, sizeof(sample), NMEMB);
+    for (size_t i = 0; i < NMEMB; i++) {
+      sample.timestamp = i;
+      sample.value = rand();
+      ref[i] = sample;
+      CHECK(cache.write(i) == sizeof(sample));
+    }
+    for (int i = 0; i < 5000; i++) {
+      size_t ix = rand() % 4;
+      if (rand() & 1) {
+	sample.timestamp = rand();
+	ref[ix] = sample;
+	CHECK(cache.write(ix) == sizeof(sample));
+      }
+      else {
+	CHECK(cache.read(ix) == sizeof(sample));
+	CHECK(memcmp(&sample, &ref[ix], sizeof(sample)) == 0);
+      }
+    }
+    CHECK(cache.hits() > cache.misses());
+    CHECK(cache.flush() >= 0);
+    sample_t res;
+    for (size_t i = 0; i < NMEMB; i++) {
+      dev.read(&res, cache.addr(i), sizeof(res));
+      CHECK(memcmp(&res, &ref[i], sizeof(res)) == 0);
+    }
+  }
+}
+
+void check_shadow_cache(AT24CXXModel& dev)
+{
+  struct config_t {
+    uint32_t timestamp;
+    char ssid[32];
+    uint8_t mac[6];
+  } config, shadow, res;
+  Storage::ShadowCache cache(dev, &config, &shadow, sizeof(config), 4);
+  memset(&config, 'a', sizeof(config));
+  CHECK(cache.write(1) == sizeof(config));
+
+  // Unchanged member is not written
+  dev.reset();
+  CHECK(cache.write(1) == sizeof(config));
+  CHECK(dev.elapsed() == 0);
+  CHECK(cache.skipped() == sizeof(config));
+
+  // Only span of changed bytes is written
+  config.mac[5] = 9;
+  config.ssid[0] = 'z';
+  CHECK(cache.write(1) == sizeof(config));
+  dev.read(&res, cache.addr(1), sizeof(res));
+  CHECK(memcmp(&res, &config, sizeof(res)) == 0);
+
+  // Range write invalidates the shadow
+  uint8_t buf[2 * sizeof(config)];
+  memset(buf, 1, sizeof(buf));
+  CHECK(cache.write(0, buf, 2) == (int) sizeof(buf));
+  CHECK(cache.write(1) == sizeof(config));
+  dev.read(&res, cache.addr(1), sizeof(res));
+  CHECK(memcmp(&res, &config, sizeof(res)) == 0);
+}
+
+int compare(const void* a, const void* b)
+{
+  uint16_t x = ((const sample_t*) a)->value;
+  uint16_t y = ((const sample_t*) b)->value;
+  return ((x > y) - (x < y));
+}
+
+void check_by_reference(MC23LCXXXModel& dev)
+{
+  static uint8_t buf[256];
+  const size_t N = 100;
+  sample_t sample, res;
+  sample_t slots[4];
+
+  // Iterator includes modified members in the slots
+  {
+    Storage::SlotCache<4> cache(dev, &sample, slots, sizeof(sample), N);
+    for (size_t i = 0; i < N; i++) {
+      sample.timestamp = i;
+      sample.value = rand() % 1000;
+      ref[i] = sample;
+      CHECK(cache.write(i) == sizeof(sample));
+    }
+    Storage::Cache::Iterator iter(cache, buf, sizeof(buf) / sizeof(sample));
+    size_t n = 0;
+    while (iter.next()) {
+      CHECK(memcmp(&sample, &ref[iter.ix()], sizeof(sample)) == 0);
+      n += 1;
+    }
+    CHECK(n == N);
+
+    // Sort does not leave stale slots
+    Storage::Cache::Sort sort(cache, buf, 64, compare);
+    CHECK(sort.run() > 0);
+    CHECK(cache.flush() == 0);
+    uint16_t prev = 0;
+    for (size_t i = 0; i < N; i++) {
+      dev.read(&res, cache.addr(i), sizeof(res));
+      CHECK(cache.read(i) == sizeof(sample));
+      CHECK(memcmp(&sample, &res, sizeof(res)) == 0);
+      CHECK(sample.value >= prev);
+      prev = sample.value;
+    }
+
+    // Capture replaces modified members in the slots
+    sample.timestamp = UINT32_MAX;
+    CHECK(cache.write(0) == sizeof(sample));
+    Storage::Cache::Capture capture(cache, buf, 4);
+    for (uint32_t i = 0; i < N; i++) {
+      sample.timestamp = i;
+      capture.put(&sample);
+      capture.pump();
+    }
+    CHECK(capture.flush() >= 0);
+    CHECK(cache.flush() == 0);
+    dev.read(&res, cache.addr(0), sizeof(res));
+    CHECK(res.timestamp == 0);
+  }
+
+  // Sort invalidates the shadow
+  {
+    Storage::ShadowCache cache(dev, &sample, slots, sizeof(sample), N);
+    for (size_t i = 0; i < N; i++) {
+      sample.timestamp = i;
+      sample.value = N - i;
+      CHECK(cache.write(i) == sizeof(sample));
+    }
+    CHECK(cache.read(0) == sizeof(sample));
+    res = sample;
+    Storage::Cache::Sort sort(cache, buf, 64, compare);
+    CHECK(sort.run() > 0);
+    sample = res;
+    CHECK(cache.write(0) == sizeof(sample));
+    dev.read(&res, cache.addr(0), sizeof(res));
+    CHECK(memcmp(&sample, &res, sizeof(res)) == 0);
+  }
+}
+
+int main()
+{
+  srand(1);
+  RAM ram(mem, sizeof(mem));
+  AT24CXXModel eeprom(ram);
+  MC23LCXXXModel sram(ram);
+  check_slot_cache(sram);
+  check_shadow_cache(eeprom);
+  check_by_reference(sram);
+  return (check_report("Cache"));
+}
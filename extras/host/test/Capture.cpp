@@ -0,0 +1,67 @@
+/**
+ * @file Capture.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Double-buffered Storage::Cache::Capture; buffer overflow and
+ * cache full drops and members in storage.
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Driver/RAM.h"
+#include "Driver/Model.h"
+
+static uint8_t mem[131072];
+
+struct sample_t {
+  uint32_t timestamp;
+  uint16_t value;
+};
+
+const size_t NMEMB = 1000;
+void check_capture(MC23LCXXXModel& dev)
+{
+  sample_t sample;
+  sample_t buffers[2 * 16];
+  Storage::Cache cache(dev, &sample, sizeof(sample), NMEMB);
+  Storage::Cache::Capture capture(cache, buffers, 16);
+  for (uint32_t i = 0; i < NMEMB + 100; i++) {
+    sample.timestamp = i;
+    sample.value = i * 3;
+    capture.put(&sample);
+    if ((i % 16) == 15) capture.pump();
+  }
+  CHECK(capture.flush() >= 0);
+  CHECK(capture.count() == NMEMB);
+  CHECK(capture.is_full());
+  CHECK(capture.overflows() == 100);
+  for (size_t i = 0; i < NMEMB; i++) {
+    CHECK(cache.read(i) == sizeof(sample));
+    CHECK(sample.timestamp == i);
+    CHECK(sample.value == (uint16_t) (i * 3));
+  }
+}
+
+int main()
+{
+  srand(1);
+  RAM ram(mem, sizeof(mem));
+  MC23LCXXXModel sram(ram);
+  check_capture(sram);
+  return (check_report("Capture"));
+}
@@ -0,0 +1,57 @@
+/**
+ * @file Check.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include "Arduino.h"
+
+HostSerial Serial;
+
+/** Number of failed checks. */
+static int check_fails = 0;
+
+/** Max number of failed checks to print. */
+static const int CHECK_PRINT_MAX = 20;
+
+/**
+ * Check given condition; count and print failure with file, line
+ * and condition. Execution continues.
+ * @param[in] cond condition.
+ */
+#define CHECK(cond)							\
+  do {									\
+    if (!(cond)) {							\
+      if (check_fails++ < CHECK_PRINT_MAX)				\
+	printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);	\
+    }									\
+  } while (0)
+
+/**
+ * Print check summary for the given test program name. Returns
+ * exit status; zero if all checks passed otherwise one.
+ * @param[in] name test program name.
+ * @return exit status.
+ */
+inline int check_report(const char* name)
+{
+  printf("%s: %s (%d failed)\n", name, check_fails ? "FAIL" : "ok",
+	 check_fails);
+  return (check_fails ? 1 : 0);
+}
+#endif
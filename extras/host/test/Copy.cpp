@@ -0,0 +1,75 @@
+/**
+ * @file Copy.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Storage::copy() against memmove() for random, possibly
+ * overlapping, regions and bounce buffer sizes; Block::copy()
+ * between devices and Stream::transfer().
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Driver/RAM.h"
+#include "Driver/Model.h"
+
+static uint8_t mem[65536];
+static uint8_t ref[65536];
+static uint8_t eeprom_mem[4096];
+
+int main()
+{
+  srand(1);
+  RAM ram(mem, sizeof(mem));
+  MC23LCXXXModel sram(ram);
+  RAM ram2(eeprom_mem, sizeof(eeprom_mem));
+  AT24CXXModel eeprom(ram2);
+  uint8_t buf[32];
+
+  // Copy within device; overlap in both directions
+  for (int i = 0; i < 2000; i++) {
+    for (int j = 0; j < 4096; j++) ref[j] = mem[j] = rand();
+    uint32_t src = rand() % 2000;
+    uint32_t dest = rand() % 2000;
+    size_t count = rand() % 2000;
+    size_t size = 1 + rand() % sizeof(buf);
+    CHECK(sram.copy(dest, sram, src, count, buf, size) == (int) count);
+    memmove(ref + dest, ref + src, count);
+    CHECK(memcmp(ref, mem, 4096) == 0);
+  }
+
+  // Copy between devices
+  Storage::Block a(sram, 1000);
+  Storage::Block b(eeprom, 1000);
+  for (int i = 0; i < 1000; i++) mem[a.addr() + i] = i * 7;
+  CHECK(b.copy(a, buf, sizeof(buf)) == 1000);
+  CHECK(memcmp(eeprom_mem + b.addr(), mem + a.addr(), 1000) == 0);
+
+  // Transfer between streams
+  Storage::Stream s1(sram, 2000);
+  Storage::Stream s2(sram, 500);
+  for (int i = 0; i < 1500; i++) s1.write((uint8_t) i);
+  CHECK(s2.transfer(s1, buf, sizeof(buf)) == 500);
+  CHECK(s1.available() == 1000);
+  CHECK(s2.available() == 500);
+  bool ok = true;
+  for (int i = 0; i < 500; i++) ok &= (s2.read() == (i & 0xff));
+  for (int i = 500; i < 1500; i++) ok &= (s1.read() == (i & 0xff));
+  CHECK(ok);
+
+  return (check_report("Copy"));
+}
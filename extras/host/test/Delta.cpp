@@ -0,0 +1,72 @@
+/**
+ * @file Delta.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Delta encoder and decoder on stream and block, with and without
+ * run-length mode. All counted records must decode when the stream
+ * or block is filled.
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Delta.h"
+#include "Driver/RAM.h"
+
+static uint8_t mem[4096];
+
+int main()
+{
+  RAM ram(mem, sizeof(mem));
+  for (size_t size = 8; size < 200; size++) {
+    for (int rle = 0; rle < 2; rle++) {
+      int32_t fields[2];
+      {
+	Storage::Stream stream(ram, size);
+	DeltaEncoder<2> encoder(stream, rle);
+	for (uint32_t i = 0; ; i++) {
+	  fields[0] = i * 10;
+	  fields[1] = ((i / 7) % 3) ? 5 : i;
+	  if (encoder.write(fields) < 0) break;
+	}
+	CHECK(encoder.flush() >= 0);
+	DeltaDecoder<2> decoder(stream, rle);
+	uint32_t n = 0;
+	while (decoder.read(fields)) {
+	  CHECK(fields[0] == (int32_t) (n * 10));
+	  n += 1;
+	}
+	CHECK(n == encoder.count());
+      }
+      {
+	Storage::Block block(ram, size);
+	DeltaEncoder<2> encoder(block, rle);
+	for (uint32_t i = 0; i < 100000; i++) {
+	  fields[0] = i * 10;
+	  fields[1] = 3;
+	  if (encoder.write(fields) < 0) break;
+	}
+	CHECK(encoder.flush() >= 0);
+	DeltaDecoder<2> decoder(block, encoder.length(), rle);
+	uint32_t n = 0;
+	while (decoder.read(fields)) n += 1;
+	CHECK(n == encoder.count());
+      }
+    }
+  }
+  return (check_report("Delta"));
+}
@@ -0,0 +1,99 @@
+/**
+ * @file Journal.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Journal; empty and cleared storage, sequence number wrap, torn
+ * newest copy and write before read.
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Journal.h"
+#include "Driver/RAM.h"
+
+static uint8_t mem[1024];
+
+struct config_t {
+  uint32_t timestamp;
+  char ssid[8];
+};
+
+int main()
+{
+  RAM ram(mem, sizeof(mem));
+  config_t config;
+  memset(&config, 0, sizeof(config));
+
+  // Erased storage; no valid copy
+  memset(mem, 0xff, sizeof(mem));
+  {
+    Journal journal(ram, &config, sizeof(config), 8);
+    CHECK(journal.read() < 0);
+    for (uint32_t i = 1; i <= 70000; i++) {
+      config.timestamp = i;
+      CHECK(journal.write() == sizeof(config));
+    }
+  }
+
+  // Newest copy after sequence number wrap
+  {
+    Journal journal(ram, &config, sizeof(config), 8);
+    config.timestamp = 0;
+    CHECK(journal.read() == sizeof(config));
+    CHECK(config.timestamp == 70000);
+    // Corrupt the newest copy; last byte of the record
+    mem[journal.addr(journal.slot()) + 4 + sizeof(config) - 1] ^= 1;
+  }
+  {
+    Journal journal(ram, &config, sizeof(config), 8);
+    CHECK(journal.read() == sizeof(config));
+    CHECK(config.timestamp == 69999);
+  }
+
+  // Write before read is newest
+  for (int k = 0; k < 20; k++) {
+    {
+      Journal journal(ram, &config, sizeof(config), 8);
+      journal.read();
+      for (int i = 0; i < k % 5; i++) {
+	config.timestamp = 1000 + i;
+	journal.write();
+      }
+    }
+    {
+      Journal journal(ram, &config, sizeof(config), 8);
+      config.timestamp = k;
+      CHECK(journal.write() == sizeof(config));
+    }
+    {
+      Journal journal(ram, &config, sizeof(config), 8);
+      config.timestamp = UINT32_MAX;
+      CHECK(journal.read() == sizeof(config));
+      CHECK(config.timestamp == (uint32_t) k);
+    }
+  }
+
+  // Cleared storage; no valid copy
+  memset(mem, 0, sizeof(mem));
+  {
+    Journal journal(ram, &config, sizeof(config), 8);
+    CHECK(journal.read() < 0);
+  }
+
+  return (check_report("Journal"));
+}
@@ -0,0 +1,114 @@
+/**
+ * @file Pager.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Pager and ext_ptr<T>; array and linked list on storage through
+ * RAM page frames, write back on flush. Read-only traversal does
+ * not write back pages.
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Pager.h"
+#include "Driver/RAM.h"
+#include "Driver/Model.h"
+#include "Driver/Probe.h"
+
+static uint8_t mem[131072];
+
+struct node_t {
+  uint32_t key;
+  uint32_t next;
+};
+
+typedef Pager<4> pager_t;
+
+int main()
+{
+  RAM ram(mem, sizeof(mem));
+  MC23LCXXXModel sram(ram);
+  uint8_t frames[4 * 64];
+  uint32_t addr;
+  {
+    pager_t pager(sram, frames, 64, 60000);
+    addr = pager.addr();
+
+    // Array; sequential access hits the frames
+    pager_t::ext_ptr<uint16_t> a = pager.alloc<uint16_t>(10000);
+    CHECK(a);
+    for (int i = 0; i < 10000; i++) a[i] = i * 3;
+    uint32_t sum = 0;
+    for (int i = 0; i < 10000; i++) sum += (uint16_t) a[i];
+    CHECK(sum == 3UL * (9999UL * 10000UL / 2));
+    CHECK(pager.hits() > 30 * pager.misses());
+    ++a;
+    CHECK((uint16_t) *a == 3);
+    CHECK((a + 5) - a == 5);
+
+    // Linked list
+    pager_t::ext_ptr<node_t> head;
+    for (int i = 0; i < 1000; i++) {
+      pager_t::ext_ptr<node_t> node = pager.alloc<node_t>();
+      CHECK(node);
+      node->key = i;
+      node->next = head.offset();
+      head = node;
+    }
+    uint32_t keys = 0;
+    int count = 0;
+    for (pager_t::ext_ptr<node_t> p = head; p;
+	 p = pager_t::ext_ptr<node_t>(pager, p->next)) {
+      keys += p->key;
+      count += 1;
+    }
+    CHECK(count == 1000);
+    CHECK(keys == 999UL * 1000UL / 2);
+  }
+
+  // Written back when the pager is destructed
+  uint16_t value;
+  ram.read(&value, addr + 2 * 77, sizeof(value));
+  CHECK(value == 77 * 3);
+
+  // Read-only traversal does not write back pages
+  {
+    Probe probe(sram);
+    pager_t pager(probe, frames, 64, 60000);
+    pager_t::ext_ptr<node_t> head;
+    for (int i = 0; i < 1000; i++) {
+      pager_t::ext_ptr<node_t> node = pager.alloc<node_t>();
+      node->key = i;
+      node->next = head.offset();
+      head = node;
+    }
+    CHECK(pager.flush() >= 0);
+    probe.reset();
+    uint32_t keys = 0;
+    for (pager_t::ext_ptr<node_t> p = head; p;
+	 p = pager_t::ext_ptr<node_t>(pager, p.get()->next))
+      keys += p.get()->key;
+    const pager_t::ext_ptr<node_t> q = head;
+    keys += q->key;
+    CHECK(keys == 999UL * 1000UL / 2 + 999UL);
+    CHECK(pager.flush() == 0);
+    CHECK(probe.stats(Probe::READ).calls > 0);
+    CHECK(probe.stats(Probe::WRITE).calls == 0);
+  }
+
+  return (check_report("Pager"));
+}
@@ -0,0 +1,93 @@
+/**
+ * @file Probe.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Probe; call, byte and failure counters, address regions, out of
+ * range queries and the open ended latency bucket in dump().
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Driver/RAM.h"
+#include "Driver/Probe.h"
+#include <string>
+
+static uint8_t mem[4096];
+
+/**
+ * RAM with slow read; 20 ms per call.
+ */
+class SlowRAM : public RAM {
+public:
+  SlowRAM(uint8_t* mem, uint32_t size) : RAM(mem, size) {}
+
+  virtual int read(void* dst, uint32_t src, size_t count)
+  {
+    delayMicroseconds(20000);
+    return (RAM::read(dst, src, count));
+  }
+};
+
+/**
+ * Print to string.
+ */
+class StringPrint : public Print {
+public:
+  using Print::write;
+  virtual size_t write(uint8_t byte)
+  {
+    str += (char) byte;
+    return (1);
+  }
+  std::string str;
+};
+
+int main()
+{
+  SlowRAM ram(mem, sizeof(mem));
+  Probe probe(ram);
+  uint8_t buf[16] = { 0 };
+
+  CHECK(probe.write(0, buf, sizeof(buf)) == sizeof(buf));
+  CHECK(probe.write(sizeof(mem) - 1, buf, sizeof(buf)) < 0);
+  CHECK(probe.read(buf, 1024, sizeof(buf)) == sizeof(buf));
+  CHECK(probe.stats(Probe::WRITE).calls == 2);
+  CHECK(probe.stats(Probe::WRITE).bytes == sizeof(buf));
+  CHECK(probe.stats(Probe::WRITE).failures == 1);
+  CHECK(probe.stats(Probe::READ).calls == 1);
+  CHECK(probe.stats(Probe::READ).histogram[Probe::BUCKET_MAX - 1] == 1);
+  CHECK(probe.region(0) == 1);
+  CHECK(probe.region(2) == 1);
+  CHECK(probe.region(Probe::REGION_MAX - 1) == 1);
+
+  // Out of range queries
+  CHECK(probe.region(Probe::REGION_MAX) == 0);
+  CHECK(probe.region(255) == 0);
+  CHECK(probe.stats(Probe::OP_MAX).calls == 0);
+
+  // Last bucket is printed with its lower bound
+  StringPrint out;
+  probe.dump(out);
+  CHECK(out.str.find(" >=16384:1") != std::string::npos);
+
+  probe.reset();
+  CHECK(probe.stats(Probe::READ).calls == 0);
+  CHECK(probe.region(0) == 0);
+
+  return (check_report("Probe"));
+}
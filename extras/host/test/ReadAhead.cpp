@@ -0,0 +1,98 @@
+/**
+ * @file ReadAhead.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Storage::ReadAheadCache; forward and backward scans coalesced
+ * and random mix of sequential, random access and write compared
+ * with a reference in host memory.
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Driver/RAM.h"
+#include "Driver/Model.h"
+
+static uint8_t mem[131072];
+
+struct sample_t {
+  uint32_t timestamp;
+  uint16_t value;
+};
+
+const size_t NMEMB = 1000;
+static sample_t ref[NMEMB];
+
+void check_read_ahead_cache(MC23LCXXXModel& dev)
+{
+  sample_t sample;
+  sample_t ahead[16];
+  Storage::Cache plain(dev, &sample, sizeof(sample), NMEMB);
+  Storage::ReadAheadCache cache(dev, &sample, ahead, 16,
+				sizeof(sample), NMEMB);
+  for (size_t i = 0; i < NMEMB; i++) {
+    sample.timestamp = i;
+    sample.value = i * 7;
+    ref[i] = sample;
+    CHECK(cache.write(i) == sizeof(sample));
+  }
+
+  // Forward and backward scans are coalesced
+  dev.reset();
+  for (size_t i = 0; i < NMEMB; i++) plain.read(i);
+  uint32_t us = dev.elapsed();
+  dev.reset();
+  for (size_t i = 0; i < NMEMB; i++) {
+    CHECK(cache.read(i) == sizeof(sample));
+    CHECK(sample.timestamp == i);
+  }
+  CHECK(dev.elapsed() < us / 2);
+  dev.reset();
+  for (size_t i = NMEMB; i-- > 0; ) {
+    CHECK(cache.read(i) == sizeof(sample));
+    CHECK(sample.timestamp == i);
+  }
+  CHECK(dev.elapsed() < us / 2);
+
+  // Random mix of sequential, random access and write
+  size_t ix = 0;
+  for (int i = 0; i < 200000; i++) {
+    int op = rand() % 10;
+    if (op < 4) ix = (ix + 1) % NMEMB;
+    else if (op < 7) ix = (ix ? ix - 1 : NMEMB - 1);
+    else if (op < 8) ix = rand() % NMEMB;
+    else {
+      sample.timestamp = rand();
+      sample.value = rand();
+      ref[ix] = sample;
+      CHECK(cache.write(ix) == sizeof(sample));
+      continue;
+    }
+    CHECK(cache.read(ix) == sizeof(sample));
+    CHECK(memcmp(&sample, &ref[ix], sizeof(sample)) == 0);
+  }
+  CHECK(cache.read(NMEMB) < 0);
+}
+
+int main()
+{
+  srand(1);
+  RAM ram(mem, sizeof(mem));
+  MC23LCXXXModel sram(ram);
+  check_read_ahead_cache(sram);
+  return (check_report("ReadAhead"));
+}
@@ -0,0 +1,83 @@
+/**
+ * @file Sort.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * External merge sort Storage::Cache::Sort against std::sort for
+ * number of members and work buffer sizes; single run, merge passes
+ * and too small work buffer.
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Driver/RAM.h"
+#include "Driver/Model.h"
+#include <algorithm>
+
+static uint8_t mem[131072];
+
+struct sample_t {
+  uint32_t timestamp;
+  uint16_t value;
+};
+
+int compare(const void* a, const void* b)
+{
+  uint16_t x = ((const sample_t*) a)->value;
+  uint16_t y = ((const sample_t*) b)->value;
+  return ((x > y) - (x < y));
+}
+
+void check_sort(MC23LCXXXModel& dev)
+{
+  static const size_t nmemb[] = { 1, 2, 100, 171, 1000, 5000 };
+  static const size_t size[] = { 24, 64, 256, 1024 };
+  static uint16_t values[5000];
+  static uint8_t buf[1024];
+  sample_t sample;
+  for (size_t i = 0; i < sizeof(nmemb) / sizeof(nmemb[0]); i++) {
+    for (size_t j = 0; j < sizeof(size) / sizeof(size[0]); j++) {
+      const size_t N = nmemb[i];
+      Storage::Cache cache(dev, &sample, sizeof(sample), N);
+      for (size_t k = 0; k < N; k++) {
+	sample.timestamp = k;
+	sample.value = rand() % 1000;
+	values[k] = sample.value;
+	cache.write(k);
+      }
+      std::sort(values, values + N);
+      Storage::Cache::Sort sort(cache, buf, size[j], compare);
+      CHECK(sort.run() > 0);
+      for (size_t k = 0; k < N; k++) {
+	cache.read(k);
+	CHECK(sample.value == values[k]);
+      }
+    }
+  }
+  Storage::Cache cache(dev, &sample, sizeof(sample), 10);
+  Storage::Cache::Sort sort(cache, buf, 2 * sizeof(sample), compare);
+  CHECK(sort.run() < 0);
+}
+
+int main()
+{
+  srand(1);
+  RAM ram(mem, sizeof(mem));
+  MC23LCXXXModel sram(ram);
+  check_sort(sram);
+  return (check_report("Sort"));
+}
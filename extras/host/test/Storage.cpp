@@ -0,0 +1,207 @@
+/**
+ * @file Storage.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Block, Cache and Stream on the memory drivers (RAM, MMAP) and the
+ * device timing models. Random operations are compared with a
+ * reference in host memory.
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Driver/RAM.h"
+#include "Driver/MMAP.h"
+#include "Driver/Model.h"
+#include <deque>
+#include <algorithm>
+
+static uint8_t mem[16384];
+
+void check_block(Storage& dev)
+{
+  static uint8_t ref[4096];
+  static uint8_t buf[512];
+  Storage::Block block(dev, sizeof(ref));
+  CHECK(block.addr() != UINT32_MAX);
+  memset(ref, 0, sizeof(ref));
+  block.write(0, ref, sizeof(ref));
+  for (int i = 0; i < 2000; i++) {
+    uint32_t offset = rand() % sizeof(ref);
+    size_t size = rand() % sizeof(buf);
+    int res;
+    if (rand() & 1) {
+      for (size_t j = 0; j < size; j++) buf[j] = rand();
+      res = block.write(offset, buf, size);
+      if (offset + size <= sizeof(ref)) {
+	CHECK(res == (int) size);
+	memcpy(ref + offset, buf, size);
+      }
+      else {
+	CHECK(res < 0);
+      }
+    }
+    else {
+      res = block.read(buf, offset, size);
+      if (offset + size <= sizeof(ref)) {
+	CHECK(res == (int) size);
+	CHECK(memcmp(buf, ref + offset, size) == 0);
+      }
+      else {
+	CHECK(res < 0);
+      }
+    }
+  }
+}
+
+void check_cache(Storage& dev)
+{
+  struct member_t {
+    uint32_t timestamp;
+    uint16_t value;
+  } member;
+  const size_t NMEMB = 200;
+  static member_t ref[NMEMB];
+  static member_t chunk[16];
+  Storage::Cache cache(dev, &member, sizeof(member), NMEMB);
+  for (size_t i = 0; i < NMEMB; i++) {
+    member.timestamp = rand();
+    member.value = rand();
+    ref[i] = member;
+    CHECK(cache.write(i) == sizeof(member));
+  }
+  CHECK(cache.write(NMEMB) < 0);
+  CHECK(cache.read(NMEMB) < 0);
+  for (size_t i = 0; i < NMEMB; i++) {
+    size_t ix = rand() % NMEMB;
+    CHECK(cache.read(ix) == sizeof(member));
+    CHECK(memcmp(&member, &ref[ix], sizeof(member)) == 0);
+  }
+  Storage::Cache::Iterator iter(cache, chunk, 16);
+  size_t n = 0;
+  while (iter.next()) {
+    CHECK(memcmp(&member, &ref[n], sizeof(member)) == 0);
+    n += 1;
+  }
+  CHECK(n == NMEMB);
+}
+
+void check_stream(Storage& dev, bool wb, bool rb, size_t size, size_t bufsize)
+{
+  uint8_t put[64];
+  uint8_t get[64];
+  uint8_t tmp[256];
+  Storage::Stream stream(dev, size, wb ? put : NULL, rb ? get : NULL, bufsize);
+  std::deque<uint8_t> ref;
+  uint8_t next = 0;
+  for (int i = 0; i < 3000; i++) {
+    size_t n = rand() % (size + 5);
+    if (n > sizeof(tmp)) n = sizeof(tmp);
+    switch (rand() % 7) {
+    case 0: {
+      size_t res = stream.write(next);
+      CHECK(res == (ref.size() < size ? 1U : 0U));
+      if (res) ref.push_back(next);
+      next += 1;
+    } break;
+    case 1: {
+      for (size_t j = 0; j < n; j++) tmp[j] = next++;
+      size_t res = stream.write(tmp, n);
+      CHECK(res == std::min(n, size - ref.size()));
+      for (size_t j = 0; j < res; j++) ref.push_back(tmp[j]);
+    } break;
+    case 2: {
+      int c = stream.read();
+      if (ref.empty()) {
+	CHECK(c == -1);
+      }
+      else {
+	CHECK(c == ref.front());
+	ref.pop_front();
+      }
+    } break;
+    case 3: {
+      size_t res = stream.read(tmp, n);
+      CHECK(res == std::min(n, ref.size()));
+      for (size_t j = 0; j < res; j++) {
+	CHECK(tmp[j] == ref.front());
+	ref.pop_front();
+      }
+    } break;
+    case 4: {
+      size_t res = stream.peek(tmp, n);
+      CHECK(res == std::min(n, ref.size()));
+      for (size_t j = 0; j < res; j++) CHECK(tmp[j] == ref[j]);
+    } break;
+    case 5: {
+      size_t res = stream.skip(n);
+      CHECK(res == std::min(n, ref.size()));
+      for (size_t j = 0; j < res; j++) ref.pop_front();
+    } break;
+    case 6: {
+      int c = stream.peek();
+      CHECK(c == (ref.empty() ? -1 : ref.front()));
+    } break;
+    }
+    CHECK((size_t) stream.available() == ref.size());
+  }
+}
+
+void check_device(Storage& dev)
+{
+  check_block(dev);
+  check_cache(dev);
+  for (int i = 0; i < 4; i++) {
+    check_stream(dev, i & 1, i & 2, 100, 32);
+    check_stream(dev, i & 1, i & 2, 97, 16);
+    check_stream(dev, i & 1, i & 2, 20, 32);
+  }
+}
+
+int main()
+{
+  srand(1);
+  RAM ram(mem, sizeof(mem));
+  check_device(ram);
+  CHECK(ram.room() == sizeof(mem));
+
+  AT24CXXModel eeprom(ram);
+  check_device(eeprom);
+  MC23LCXXXModel sram(ram);
+  check_device(sram);
+  CHECK(sram.elapsed() > 0);
+
+  const char* path = "Storage.mmap";
+  {
+    MMAP mmap(path, sizeof(mem));
+    CHECK(mmap.is_open());
+    if (mmap.is_open()) {
+      check_device(mmap);
+      uint32_t magic = 0x12345678;
+      mmap.write(sizeof(mem) - sizeof(magic), &magic, sizeof(magic));
+    }
+  }
+  {
+    MMAP mmap(path, sizeof(mem));
+    uint32_t magic = 0;
+    mmap.read(&magic, sizeof(mem) - sizeof(magic), sizeof(magic));
+    CHECK(magic == 0x12345678);
+  }
+  unlink(path);
+
+  return (check_report("Storage"));
+}
@@ -0,0 +1,75 @@
+/**
+ * @file Vector.cpp
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+/*
+ * Typed Storage::Vector<T, N>; element reference proxy, iterator
+ * and range access, and a zero value when the device read fails.
+ */
+
+#include "Check.h"
+#include "Storage.h"
+#include "Driver/RAM.h"
+
+static uint8_t mem[4096];
+
+/**
+ * RAM with failing read when disabled.
+ */
+class FailRAM : public RAM {
+public:
+  FailRAM(uint8_t* mem, uint32_t size) : RAM(mem, size), fail(false) {}
+
+  virtual int read(void* dst, uint32_t src, size_t count)
+  {
+    if (fail) return (-1);
+    return (RAM::read(dst, src, count));
+  }
+
+  bool fail;
+};
+
+int main()
+{
+  FailRAM ram(mem, sizeof(mem));
+  memset(mem, 0xa5, sizeof(mem));
+  Storage::Vector<uint32_t, 100> vec(ram);
+
+  // Reference proxy and iterator
+  for (size_t i = 0; i < 100; i++) vec[i] = i * 7;
+  vec[3] = vec[5];
+  CHECK((uint32_t) vec[3] == 35);
+  uint32_t sum = 0;
+  for (Storage::Vector<uint32_t, 100>::Iterator it = vec.begin();
+       it != vec.end();
+       ++it)
+    sum += *it;
+  CHECK(sum == 7UL * (99UL * 100UL / 2) - 21 + 35);
+
+  // Range access
+  uint32_t buf[10];
+  CHECK(vec.read(buf, 90, 10) == sizeof(buf));
+  CHECK(buf[9] == 99 * 7);
+  CHECK(vec.read(buf, 95, 10) < 0);
+
+  // Failed read returns zero
+  ram.fail = true;
+  CHECK((uint32_t) vec[10] == 0);
+  CHECK(*vec.begin() == 0);
+
+  return (check_report("Vector"));
+}
@@ -0,0 +1,316 @@
+/**
+ * @file Async.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef ASYNC_H
+#define ASYNC_H
+
+#include "Storage.h"
+
+/**
+ * Asynchronous storage requests. Read and write requests are
+ * submitted to a bounded queue and executed when the queue is
+ * pumped; from loop(), a timer interrupt or a worker thread (host).
+ */
+class Async {
+public:
+  /**
+   * Storage request; operation, address, buffer and completion
+   * callback. The request is owned by the caller and must not be
+   * modified until completed.
+   */
+  class Request {
+  public:
+    /** Request operations. */
+    enum {
+      READ = 0,			//!< Read from storage to buffer.
+      WRITE = 1			//!< Write buffer to storage.
+    };
+
+    /**
+     * Completion callback; called by the pump when the request is
+     * completed.
+     * @param[in] req completed request.
+     */
+    typedef void (*callback_t)(Request& req);
+
+    /**
+     * Construct idle request with the given completion callback and
+     * environment (default none).
+     * @param[in] callback completion callback (default NULL).
+     * @param[in] env callback environment (default NULL).
+     */
+    Request(callback_t callback = NULL, void* env = NULL) :
+      op(READ),
+      addr(0),
+      buf(NULL),
+      count(0),
+      callback(callback),
+      env(env),
+      res(0),
+      m_done(true)
+    {
+    }
+
+    /**
+     * Return true(1) if the request is completed (or idle),
+     * otherwise false(0).
+     * @return bool.
+     */
+    bool is_done()
+    {
+      return (m_done);
+    }
+
+    /** Request operation. */
+    uint8_t op;
+
+    /** Storage address. */
+    uint32_t addr;
+
+    /** Buffer pointer. */
+    void* buf;
+
+    /** Number of bytes. */
+    size_t count;
+
+    /** Completion callback or NULL. */
+    callback_t callback;
+
+    /** Callback environment. */
+    void* env;
+
+    /** Number of bytes or negative error code when completed. */
+    int res;
+
+  protected:
+    friend class Async;
+
+    /** Completed flag. */
+    volatile bool m_done;
+  };
+
+  /**
+   * Bounded request queue on storage device. Requests are executed
+   * in order with the device synchronous read() and write(). The
+   * queue is single producer (submit) and single consumer (pump);
+   * the pump may be called from an interrupt handler if the device
+   * allows it. Submit, pump, flush and wait are virtual so that a
+   * queue variant (e.g. AsyncThread) may be used through a queue
+   * reference.
+   * @param[in] QUEUE_MAX max number of queued requests (power of 2).
+   */
+  template<uint8_t QUEUE_MAX>
+  class Queue {
+    static_assert((QUEUE_MAX != 0)
+		  && ((QUEUE_MAX & (QUEUE_MAX - 1)) == 0)
+		  && (QUEUE_MAX <= 128),
+		  "QUEUE_MAX must be a power of 2 (max 128)");
+  public:
+    /**
+     * Construct request queue on given storage device.
+     * @param[in] dev storage device.
+     */
+    Queue(Storage& dev) :
+      m_dev(dev),
+      m_put(0),
+      m_get(0),
+      m_busy(false)
+    {
+    }
+
+    /**
+     * Returns number of queued requests.
+     * @return number of requests.
+     */
+    uint8_t available()
+    {
+      return ((uint8_t) (m_put - m_get));
+    }
+
+    /**
+     * Returns number of requests that may be submitted.
+     * @return number of requests.
+     */
+    uint8_t room()
+    {
+      return (QUEUE_MAX - available());
+    }
+
+    /**
+     * Submit request to read given number of bytes from storage
+     * address to buffer. Returns zero if queued otherwise negative
+     * error code (queue full or request not completed).
+     * @param[in] req request.
+     * @param[in] dst destination buffer pointer.
+     * @param[in] src source memory address on device.
+     * @param[in] count number of bytes to read from device.
+     * @return zero or negative error code.
+     */
+    virtual int read(Request& req, void* dst, uint32_t src, size_t count)
+    {
+      if (!req.m_done) return (-1);
+      req.op = Request::READ;
+      req.addr = src;
+      req.buf = dst;
+      req.count = count;
+      return (submit(req));
+    }
+
+    /**
+     * Submit request to write given number of bytes from buffer to
+     * storage address. Returns zero if queued otherwise negative
+     * error code (queue full or request not completed).
+     * @param[in] req request.
+     * @param[in] dst destination memory address on device.
+     * @param[in] src source buffer pointer.
+     * @param[in] count number of bytes to write to device.
+     * @return zero or negative error code.
+     */
+    virtual int write(Request& req, uint32_t dst, const void* src, size_t count)
+    {
+      if (!req.m_done) return (-1);
+      req.op = Request::WRITE;
+      req.addr = dst;
+      req.buf = (void*) src;
+      req.count = count;
+      return (submit(req));
+    }
+
+    /**
+     * Execute next queued request and call the completion
+     * callback. Returns true(1) if a request was executed otherwise
+     * false(0); queue empty or pump already running. The pump is
+     * claimed with interrupts disabled so that it may also be called
+     * from an interrupt handler.
+     * @return bool.
+     */
+    virtual bool pump()
+    {
+      uint8_t sreg = SREG;
+      noInterrupts();
+      if (m_busy || (m_put == m_get)) {
+	SREG = sreg;
+	return (false);
+      }
+      m_busy = true;
+      SREG = sreg;
+      Request& req = *m_queue[m_get & MASK];
+      execute(req);
+      m_get += 1;
+      complete(req);
+      m_busy = false;
+      return (true);
+    }
+
+    /**
+     * Execute queued requests until the queue is empty.
+     */
+    virtual void flush()
+    {
+      while (pump());
+    }
+
+    /**
+     * Wait for given request to complete; pump queue while the
+     * request is pending. Returns request result.
+     * @param[in] req request.
+     * @return number of bytes or negative error code.
+     */
+    virtual int wait(Request& req)
+    {
+      while (!req.m_done) pump();
+      return (req.res);
+    }
+
+  protected:
+    /** Queue index mask. */
+    static const uint8_t MASK = QUEUE_MAX - 1;
+
+    /** Storage device. */
+    Storage& m_dev;
+
+    /** Queued requests. */
+    Request* m_queue[QUEUE_MAX];
+
+    /** Queue put index. */
+    volatile uint8_t m_put;
+
+    /** Queue get index. */
+    volatile uint8_t m_get;
+
+    /** Pump is running. */
+    volatile bool m_busy;
+
+    /**
+     * Queue given request. Returns zero if queued otherwise negative
+     * error code.
+     * @param[in] req request.
+     * @return zero or negative error code.
+     */
+    int submit(Request& req)
+    {
+      if ((uint8_t) (m_put - m_get) == QUEUE_MAX) return (-1);
+      req.m_done = false;
+      m_queue[m_put & MASK] = &req;
+      m_put += 1;
+      return (0);
+    }
+
+    /**
+     * Execute given request with synchronous device read() or
+     * write(), and set request result.
+     * @param[in] req request.
+     */
+    void execute(Request& req)
+    {
+      if (req.op == Request::READ)
+	req.res = m_dev.read(req.buf, req.addr, req.count);
+      else
+	req.res = m_dev.write(req.addr, req.buf, req.count);
+    }
+
+    /**
+     * Mark given request as completed.
+     * @param[in] req request.
+     */
+    static void done(Request& req)
+    {
+      req.m_done = true;
+    }
+
+    /**
+     * Call completion callback of given request.
+     * @param[in] req request.
+     */
+    static void notify(Request& req)
+    {
+      if (req.callback != NULL) req.callback(req);
+    }
+
+    /**
+     * Mark given request as completed and call completion callback.
+     * @param[in] req request.
+     */
+    static void complete(Request& req)
+    {
+      done(req);
+      notify(req);
+    }
+  };
+};
+#endif
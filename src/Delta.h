@@ -0,0 +1,388 @@
+/**
+ * @file Delta.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef DELTA_H
+#define DELTA_H
+
+#include "Storage.h"
+
+/**
+ * Delta encoding of records with N integer fields (e.g. timestamp
+ * and sample value) to storage stream or block. Each field is
+ * encoded as the difference to the previous record; zigzag mapped
+ * to unsigned and written as varint (7-bit groups, least significant
+ * first, high bit set when more bytes follow). Small changes require
+ * a single byte per field.
+ *
+ * In run-length mode each record is prefixed with a varint; zero for
+ * a literal record with field deltas, or the number of records with
+ * the same field deltas as the previous record (no field deltas).
+ * The run is written on the next literal record or flush(); a
+ * record only extends the run if there is room for the run varint.
+ * @param[in] N number of fields per record.
+ */
+template<uint8_t N>
+class DeltaEncoder {
+public:
+  /** Max number of bytes per encoded record; run and fields. */
+  static const uint8_t RECORD_MAX = 5 + 1 + N * 5;
+
+  /**
+   * Construct encoder on given storage stream and mode. Records are
+   * only written when the stream has room for the whole record.
+   * @param[in] stream storage stream.
+   * @param[in] rle run-length mode (default false).
+   */
+  DeltaEncoder(Storage::Stream& stream, bool rle = false) :
+    m_stream(&stream),
+    m_block(NULL),
+    m_rle(rle)
+  {
+    reset();
+  }
+
+  /**
+   * Construct encoder on given storage block and mode. Records are
+   * written from the beginning of the block.
+   * @param[in] block storage block.
+   * @param[in] rle run-length mode (default false).
+   */
+  DeltaEncoder(Storage::Block& block, bool rle = false) :
+    m_stream(NULL),
+    m_block(&block),
+    m_rle(rle)
+  {
+    reset();
+  }
+
+  /**
+   * Restart encoding; previous record is zero and block position is
+   * the beginning of the block. Pending run is discarded.
+   */
+  void reset()
+  {
+    memset(m_prev, 0, sizeof(m_prev));
+    memset(m_delta, 0, sizeof(m_delta));
+    m_run = 0;
+    m_count = 0;
+    m_length = 0;
+  }
+
+  /**
+   * Encode and write given record fields. Returns number of bytes
+   * written, zero if the record extended the current run, or
+   * negative error code if there is no room (for the record or the
+   * extended run).
+   * @param[in] fields record fields.
+   * @return number of bytes or negative error code.
+   */
+  int write(const int32_t* fields)
+  {
+    int32_t delta[N];
+    bool repeat = m_rle && (m_run < UINT16_MAX);
+    for (uint8_t i = 0; i < N; i++) {
+      delta[i] = (int32_t) ((uint32_t) fields[i] - (uint32_t) m_prev[i]);
+      if (delta[i] != m_delta[i]) repeat = false;
+    }
+    if (repeat) {
+      uint8_t buf[5];
+      if (room() < put(buf, m_run + 1)) return (-1);
+      memcpy(m_prev, fields, sizeof(m_prev));
+      m_run += 1;
+      m_count += 1;
+      return (0);
+    }
+    uint8_t buf[RECORD_MAX];
+    uint8_t len = 0;
+    if (m_run != 0) len += put(buf + len, m_run);
+    if (m_rle) buf[len++] = 0;
+    for (uint8_t i = 0; i < N; i++)
+      len += put(buf + len, ((uint32_t) delta[i] << 1) ^ (delta[i] >> 31));
+    if (emit(buf, len) < 0) return (-1);
+    memcpy(m_prev, fields, sizeof(m_prev));
+    memcpy(m_delta, delta, sizeof(m_delta));
+    m_run = 0;
+    m_count += 1;
+    return (len);
+  }
+
+  /**
+   * Write pending run. Returns number of bytes written or negative
+   * error code if there is no room.
+   * @return number of bytes or negative error code.
+   */
+  int flush()
+  {
+    if (m_run == 0) return (0);
+    uint8_t buf[5];
+    uint8_t len = put(buf, m_run);
+    if (emit(buf, len) < 0) return (-1);
+    m_run = 0;
+    return (len);
+  }
+
+  /**
+   * Returns number of encoded records.
+   * @return number of records.
+   */
+  uint32_t count()
+  {
+    return (m_count);
+  }
+
+  /**
+   * Returns number of written bytes.
+   * @return number of bytes.
+   */
+  uint32_t length()
+  {
+    return (m_length);
+  }
+
+protected:
+  /** Storage stream or NULL. */
+  Storage::Stream* m_stream;
+
+  /** Storage block or NULL. */
+  Storage::Block* m_block;
+
+  /** Run-length mode. */
+  const bool m_rle;
+
+  /** Previous record fields. */
+  int32_t m_prev[N];
+
+  /** Previous record field deltas. */
+  int32_t m_delta[N];
+
+  /** Number of pending records in run. */
+  uint16_t m_run;
+
+  /** Number of encoded records. */
+  uint32_t m_count;
+
+  /** Number of written bytes. */
+  uint32_t m_length;
+
+  /**
+   * Write given varint encoded value to buffer. Returns number of
+   * bytes (1..5).
+   * @param[in] buf buffer pointer.
+   * @param[in] value to encode.
+   * @return number of bytes.
+   */
+  static uint8_t put(uint8_t* buf, uint32_t value)
+  {
+    uint8_t len = 0;
+    while (value > 0x7f) {
+      buf[len++] = (value & 0x7f) | 0x80;
+      value >>= 7;
+    }
+    buf[len++] = value;
+    return (len);
+  }
+
+  /**
+   * Returns number of bytes that may be written to stream or block.
+   * @return number of bytes.
+   */
+  uint32_t room()
+  {
+    if (m_stream != NULL)
+      return (m_stream->SIZE - m_stream->available());
+    return (m_block->SIZE - m_length);
+  }
+
+  /**
+   * Write given buffer to stream or block if there is room for all
+   * bytes. Returns number of bytes written or negative error code.
+   * @param[in] buf buffer pointer.
+   * @param[in] len number of bytes.
+   * @return number of bytes or negative error code.
+   */
+  int emit(const uint8_t* buf, uint8_t len)
+  {
+    if (room() < len) return (-1);
+    if (m_stream != NULL) {
+      if (m_stream->write(buf, len) != len) return (-1);
+    }
+    else {
+      if (m_block->write(m_length, buf, len) < 0) return (-1);
+    }
+    m_length += len;
+    return (len);
+  }
+};
+
+/**
+ * Decoding of delta encoded records with N integer fields from
+ * storage stream or block. The stream or block is read in chunks to
+ * an internal buffer.
+ * @param[in] N number of fields per record.
+ */
+template<uint8_t N>
+class DeltaDecoder {
+public:
+  /** Number of bytes in read buffer. */
+  static const uint8_t BUF_MAX = 16;
+
+  /**
+   * Construct decoder on given storage stream and mode.
+   * @param[in] stream storage stream.
+   * @param[in] rle run-length mode (default false).
+   */
+  DeltaDecoder(Storage::Stream& stream, bool rle = false) :
+    m_stream(&stream),
+    m_block(NULL),
+    m_size(0),
+    m_rle(rle)
+  {
+    reset();
+  }
+
+  /**
+   * Construct decoder on given storage block, number of encoded
+   * bytes (see DeltaEncoder::length()) and mode.
+   * @param[in] block storage block.
+   * @param[in] size number of encoded bytes in block.
+   * @param[in] rle run-length mode (default false).
+   */
+  DeltaDecoder(Storage::Block& block, uint32_t size, bool rle = false) :
+    m_stream(NULL),
+    m_block(&block),
+    m_size(size),
+    m_rle(rle)
+  {
+    reset();
+  }
+
+  /**
+   * Restart decoding; previous record is zero and block position is
+   * the beginning of the block.
+   */
+  void reset()
+  {
+    memset(m_prev, 0, sizeof(m_prev));
+    memset(m_delta, 0, sizeof(m_delta));
+    m_run = 0;
+    m_offset = 0;
+    m_pos = 0;
+    m_len = 0;
+  }
+
+  /**
+   * Read and decode next record to given fields. Returns true(1) if
+   * a record was decoded otherwise false(0).
+   * @param[out] fields record fields.
+   * @return bool.
+   */
+  bool read(int32_t* fields)
+  {
+    if (m_rle && (m_run == 0) && !get(m_run)) return (false);
+    if (m_rle && (m_run != 0)) {
+      m_run -= 1;
+    }
+    else {
+      for (uint8_t i = 0; i < N; i++) {
+	uint32_t value;
+	if (!get(value)) return (false);
+	m_delta[i] = (int32_t) (value >> 1) ^ -(int32_t) (value & 1);
+      }
+    }
+    for (uint8_t i = 0; i < N; i++) {
+      m_prev[i] = (int32_t) ((uint32_t) m_prev[i] + (uint32_t) m_delta[i]);
+      fields[i] = m_prev[i];
+    }
+    return (true);
+  }
+
+protected:
+  /** Storage stream or NULL. */
+  Storage::Stream* m_stream;
+
+  /** Storage block or NULL. */
+  Storage::Block* m_block;
+
+  /** Number of encoded bytes in block. */
+  const uint32_t m_size;
+
+  /** Run-length mode. */
+  const bool m_rle;
+
+  /** Previous record fields. */
+  int32_t m_prev[N];
+
+  /** Previous record field deltas. */
+  int32_t m_delta[N];
+
+  /** Number of remaining records in run. */
+  uint32_t m_run;
+
+  /** Block read offset. */
+  uint32_t m_offset;
+
+  /** Read buffer. */
+  uint8_t m_buf[BUF_MAX];
+
+  /** Position in read buffer. */
+  uint8_t m_pos;
+
+  /** Number of bytes in read buffer. */
+  uint8_t m_len;
+
+  /**
+   * Read varint encoded value. Returns true(1) if successful
+   * otherwise false(0).
+   * @param[out] value decoded value.
+   * @return bool.
+   */
+  bool get(uint32_t& value)
+  {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+      if ((m_pos == m_len) && !fill()) return (false);
+      uint8_t c = m_buf[m_pos++];
+      value |= ((uint32_t) (c & 0x7f)) << shift;
+      if ((c & 0x80) == 0) return (true);
+    }
+    return (false);
+  }
+
+  /**
+   * Fill read buffer from stream or block. Returns true(1) if bytes
+   * were read otherwise false(0).
+   * @return bool.
+   */
+  bool fill()
+  {
+    size_t n;
+    if (m_stream != NULL) {
+      n = m_stream->read(m_buf, BUF_MAX);
+    }
+    else {
+      n = m_size - m_offset;
+      if (n > BUF_MAX) n = BUF_MAX;
+      if ((n != 0) && (m_block->read(m_buf, m_offset, n) < 0)) n = 0;
+      m_offset += n;
+    }
+    m_pos = 0;
+    m_len = n;
+    return (n != 0);
+  }
+};
+#endif
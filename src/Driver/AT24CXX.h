@@ -48,8 +48,17 @@ public:
     Storage((size / CHARBITS) * 1024UL),
     TWI::Device(twi, 0x50 | (subaddr & 0x07)),
     PAGE_MAX(page_max),
-    PAGE_MASK(page_max - 1)
-  {}
+    PAGE_MASK(page_max - 1),
+    m_deferred(true),
+    m_pending(false),
+    m_update(false),
+    m_skipped_pages(0),
+    m_skipped_bytes(0)
+  {
+#if defined(STORAGE_STATS)
+    reset();
+#endif
+  }
 
   /** Number of bytes in max write page size. */
   const uint16_t PAGE_MAX;
@@ -64,7 +73,52 @@ public:
     if (!acquire()) return (false);
     int res = write(NULL);
     if (!release()) return (false);
-    return (res == 0);
+    if (res != 0) return (false);
+    m_pending = false;
+    return (true);
+  }
+
+  /**
+   * Return true(1) if a page write cycle may be in progress,
+   * otherwise false(0). The state is updated by is_ready() and
+   * sync(); no bus access.
+   * @return bool.
+   */
+  bool is_pending()
+  {
+    return (m_pending);
+  }
+
+  /**
+   * Wait for pending page write cycle to complete. Return true(1)
+   * if the device is ready otherwise false(0) on timeout.
+   * @return bool.
+   */
+  bool sync()
+  {
+    if (!m_pending) return (true);
+    uint32_t start = micros();
+    while (!is_ready()) {
+      if (micros() - start >= RETRY_TIMEOUT_US) return (false);
+      delayMicroseconds(POLL_DELAY_US);
+    }
+#if defined(STORAGE_STATS)
+    m_waits += 1;
+    m_wait_us += micros() - start;
+#endif
+    return (true);
+  }
+
+  /**
+   * Set deferred write cycle mode. In deferred mode (default) write()
+   * returns when the last page has been sent and the write cycle is
+   * waited for by the next read() or write(), or sync(). Otherwise
+   * write() waits for the write cycle to complete before returning.
+   * @param[in] enable deferred write cycle mode.
+   */
+  void deferred(bool enable)
+  {
+    m_deferred = enable;
   }
 
   /**
@@ -78,19 +132,20 @@ public:
    */
   virtual int read(void* dst, uint32_t src, size_t count)
   {
-    uint8_t retry = RETRY_MAX;
     uint16_t addr = __builtin_bswap16(src);
+    if (!sync()) return (-1);
+    uint32_t start = micros();
     do {
       if (!acquire()) return (-1);
       int res = write(&addr, sizeof(addr));
-      if (res == sizeof(addr)) {
-	res = read(dst, count);
-	if (!release()) break;
-	if (res == (int) count) return (res);
-      }
+      if (res == sizeof(addr)) res = read(dst, count);
       if (!release()) return (-1);
-      delay(RETRY_DELAY_MS);
-    } while (--retry);
+      if (res == (int) count) return (res);
+#if defined(STORAGE_STATS)
+      m_retries += 1;
+#endif
+      delayMicroseconds(POLL_DELAY_US);
+    } while (micros() - start < RETRY_TIMEOUT_US);
     return (-1);
   }
 
@@ -110,39 +165,339 @@ public:
     size_t n = PAGE_MAX - (dst & PAGE_MASK);
     if (n > s) n = s;
     while (1) {
-      uint8_t retry = RETRY_MAX;
-      uint16_t addr = __builtin_bswap16(dst);
-      iovec_t vec[3];
-      iovec_t* vp = vec;
-      int res = -1;
-      iovec_arg(vp, &addr, sizeof(addr));
-      iovec_arg(vp, p, n);
-      iovec_end(vp);
-      do {
-	if (!acquire()) continue;
-	res = write(vec);
-	if (!release()) continue;
-	if (res > 0) break;
-	delay(RETRY_DELAY_MS);
-      } while (--retry);
+      int res = (m_update ? update_page(dst, p, n) : write_page(dst, p, n));
       if (res < 0) return (-1);
       s -= n;
-      if (s == 0) return (count);
+      if (s == 0) break;
       dst += n;
       p += n;
       n = (s < PAGE_MAX ? s : PAGE_MAX);
     }
+    if (!m_deferred && !sync()) return (-1);
+    return (count);
+  }
+
+  /**
+   * @override{Storage}
+   * Read given number of segments from eeprom to the segment
+   * buffers. Adjacent segments are read in the same bus transaction
+   * without a new address. Returns number of bytes read or negative
+   * error code.
+   * @param[in] vec segment vector.
+   * @param[in] count number of segments.
+   * @return number of bytes read or negative error code.
+   */
+  virtual int readv(const vec_t* vec, size_t count)
+  {
+    int res = 0;
+    if (!sync()) return (-1);
+    while (count != 0) {
+      size_t n = 1;
+      while ((n < count) && (vec[n].addr == vec[n - 1].addr + vec[n - 1].size))
+	n++;
+      uint16_t addr = __builtin_bswap16(vec[0].addr);
+      uint32_t start = micros();
+      bool done = false;
+      do {
+	if (!acquire()) return (-1);
+	done = (write(&addr, sizeof(addr)) == sizeof(addr));
+	for (size_t i = 0; done && (i < n); i++)
+	  done = (read(vec[i].buf, vec[i].size) == (int) vec[i].size);
+	if (!release()) return (-1);
+	if (done) break;
+#if defined(STORAGE_STATS)
+	m_retries += 1;
+#endif
+	delayMicroseconds(POLL_DELAY_US);
+      } while (micros() - start < RETRY_TIMEOUT_US);
+      if (!done) return (-1);
+      for (size_t i = 0; i < n; i++) res += vec[i].size;
+      vec += n;
+      count -= n;
+    }
+    return (res);
+  }
+
+  /**
+   * @override{Storage}
+   * Write given number of segments from the segment buffers to
+   * eeprom. Adjacent segments within a page are written in the same
+   * page write (max VEC_MAX buffers). Returns number of bytes written
+   * or negative error code.
+   * @param[in] vec segment vector.
+   * @param[in] count number of segments.
+   * @return number of bytes written or negative error code.
+   */
+  virtual int writev(const vec_t* vec, size_t count)
+  {
+    if (m_update) return (Storage::writev(vec, count));
+    int res = 0;
+    uint32_t dst = 0;
+    const uint8_t* p = NULL;
+    size_t s = 0;
+    while (1) {
+      if (s == 0) {
+	if (count == 0) break;
+	dst = vec->addr;
+	p = (const uint8_t*) vec->buf;
+	s = vec->size;
+	vec++;
+	count--;
+	continue;
+      }
+      uint16_t addr = __builtin_bswap16(dst);
+      size_t room = PAGE_MAX - (dst & PAGE_MASK);
+      iovec_t iov[VEC_MAX + 2];
+      iovec_t* vp = iov;
+      iovec_arg(vp, &addr, sizeof(addr));
+      for (uint8_t i = 0; i < VEC_MAX; i++) {
+	size_t n = (s < room ? s : room);
+	iovec_arg(vp, p, n);
+	res += n;
+	dst += n;
+	p += n;
+	s -= n;
+	room -= n;
+	if (s != 0) break;
+	while ((count != 0) && (vec->size == 0)) {
+	  vec++;
+	  count--;
+	}
+	if ((room == 0) || (count == 0) || (vec->addr != dst)) break;
+	p = (const uint8_t*) vec->buf;
+	s = vec->size;
+	vec++;
+	count--;
+      }
+      iovec_end(vp);
+      if (write_vec(iov) < 0) return (-1);
+    }
+    if (!m_deferred && !sync()) return (-1);
+    return (res);
+  }
+
+  /**
+   * Set update mode. In update mode write() reads each affected page
+   * and only writes the changed bytes of the page. Unchanged pages
+   * are skipped and do not require a write cycle.
+   * @param[in] enable update mode.
+   */
+  void update(bool enable)
+  {
+    m_update = enable;
+  }
+
+  /**
+   * Returns number of pages skipped in update mode.
+   * @return number of pages.
+   */
+  uint32_t skipped_pages()
+  {
+    return (m_skipped_pages);
+  }
+
+  /**
+   * Returns number of bytes skipped in update mode.
+   * @return number of bytes.
+   */
+  uint32_t skipped_bytes()
+  {
+    return (m_skipped_bytes);
   }
 
+#if defined(STORAGE_STATS)
+  /**
+   * Returns number of acknowledge poll retries in read and write.
+   * @return number of retries.
+   */
+  uint32_t retries()
+  {
+    return (m_retries);
+  }
+
+  /**
+   * Returns number of waits for pending write cycle.
+   * @return number of waits.
+   */
+  uint32_t waits()
+  {
+    return (m_waits);
+  }
+
+  /**
+   * Returns total time waiting for pending write cycles.
+   * @return micro-seconds.
+   */
+  uint32_t wait_us()
+  {
+    return (m_wait_us);
+  }
+
+  /**
+   * Reset device statistics; retries, write cycle waits and skipped
+   * pages and bytes.
+   */
+  void reset()
+  {
+    m_retries = 0;
+    m_waits = 0;
+    m_wait_us = 0;
+    m_skipped_pages = 0;
+    m_skipped_bytes = 0;
+  }
+
+  /**
+   * Print device statistics to the given output stream.
+   * @param[in] out output stream.
+   */
+  void dump(Print& out)
+  {
+    out.print(F("AT24CXX: retries = "));
+    out.print(m_retries);
+    out.print(F(", waits = "));
+    out.print(m_waits);
+    out.print(F(", wait_us = "));
+    out.print(m_wait_us);
+    out.print(F(", skipped_pages = "));
+    out.print(m_skipped_pages);
+    out.print(F(", skipped_bytes = "));
+    out.println(m_skipped_bytes);
+  }
+#endif
+
 protected:
   /** Memory addres page mask. */
   const uint16_t PAGE_MASK;
 
-  /** Maximum number of read/write page retries: 20 ms */
-  static const uint8_t RETRY_MAX = 20;
+  /**
+   * Maximum time to poll the device for read/write page
+   * acknowledge: 20 ms.
+   */
+  static const uint16_t RETRY_TIMEOUT_US = 20000;
+
+  /**
+   * Delay between acknowledge polls during write cycle: 100 us. The
+   * write is completed at most one poll after the device is ready.
+   */
+  static const uint16_t POLL_DELAY_US = 100;
+
+  /** Maximum number of segment buffers per page write. */
+  static const uint8_t VEC_MAX = 4;
+
+  /** Number of bytes per compare chunk in page update. */
+  static const uint8_t UPDATE_CHUNK_MAX = 16;
 
-  /** Retry delay time: 1 ms */
-  static const uint8_t RETRY_DELAY_MS = 1;
+  /** Deferred write cycle mode. */
+  bool m_deferred;
+
+  /** Page write cycle may be in progress. */
+  bool m_pending;
+
+  /** Update mode. */
+  bool m_update;
+
+  /** Number of pages skipped in update mode. */
+  uint32_t m_skipped_pages;
+
+  /** Number of bytes skipped in update mode. */
+  uint32_t m_skipped_bytes;
+
+#if defined(STORAGE_STATS)
+  /** Number of acknowledge poll retries. */
+  uint32_t m_retries;
+
+  /** Number of waits for pending write cycle. */
+  uint32_t m_waits;
+
+  /** Total write cycle wait time in micro-seconds. */
+  uint32_t m_wait_us;
+#endif
+
+  /**
+   * Write given number of bytes within a page at given address with
+   * the contents from the buffer. The pending write cycle is waited
+   * for and a new write cycle is started. Return number of bytes
+   * written or negative error code.
+   * @param[in] dst address in eeprom to write to.
+   * @param[in] src buffer to write to eeprom.
+   * @param[in] count number of bytes to write (max page).
+   * @return number of bytes or negative error code.
+   */
+  int write_page(uint32_t dst, const uint8_t* src, size_t count)
+  {
+    uint16_t addr = __builtin_bswap16(dst);
+    iovec_t vec[3];
+    iovec_t* vp = vec;
+    iovec_arg(vp, &addr, sizeof(addr));
+    iovec_arg(vp, src, count);
+    iovec_end(vp);
+    if (write_vec(vec) < 0) return (-1);
+    return (count);
+  }
+
+  /**
+   * Write given page write vector; address and data buffers within a
+   * page. The pending write cycle is waited for and a new write cycle
+   * is started. Return number of bytes written (including address)
+   * or negative error code.
+   * @param[in] vec page write vector.
+   * @return number of bytes or negative error code.
+   */
+  int write_vec(iovec_t* vec)
+  {
+    int res = -1;
+    if (!sync()) return (-1);
+    uint32_t start = micros();
+    do {
+      if (!acquire()) continue;
+      res = write(vec);
+      if (!release()) continue;
+      if (res > 0) break;
+#if defined(STORAGE_STATS)
+      m_retries += 1;
+#endif
+      delayMicroseconds(POLL_DELAY_US);
+    } while (micros() - start < RETRY_TIMEOUT_US);
+    if (res < 0) return (-1);
+    m_pending = true;
+    return (res);
+  }
+
+  /**
+   * Update given number of bytes within a page at given address with
+   * the contents from the buffer. The page is read and compared in
+   * chunks and only the span of changed bytes is written. Return
+   * number of bytes updated or negative error code.
+   * @param[in] dst address in eeprom to write to.
+   * @param[in] src buffer to write to eeprom.
+   * @param[in] count number of bytes to write (max page).
+   * @return number of bytes or negative error code.
+   */
+  int update_page(uint32_t dst, const uint8_t* src, size_t count)
+  {
+    if (count == 0) return (0);
+    uint8_t chunk[UPDATE_CHUNK_MAX];
+    size_t first = count;
+    size_t last = 0;
+    for (size_t pos = 0; pos < count; pos += sizeof(chunk)) {
+      size_t n = count - pos;
+      if (n > sizeof(chunk)) n = sizeof(chunk);
+      if (read(chunk, dst + pos, n) < 0) return (-1);
+      for (size_t i = 0; i < n; i++) {
+	if (chunk[i] == src[pos + i]) continue;
+	if (first == count) first = pos + i;
+	last = pos + i + 1;
+      }
+    }
+    if (first == count) {
+      m_skipped_pages += 1;
+      m_skipped_bytes += count;
+      return (count);
+    }
+    m_skipped_bytes += count - (last - first);
+    if (write_page(dst + first, src + first, last - first) < 0) return (-1);
+    return (count);
+  }
 
   using TWI::Device::read;
   using TWI::Device::write;
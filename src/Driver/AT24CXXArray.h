@@ -0,0 +1,156 @@
+/**
+ * @file AT24CXXArray.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef AT24CXX_ARRAY_H
+#define AT24CXX_ARRAY_H
+
+#include "Storage.h"
+#include "Driver/AT24CXX.h"
+
+/**
+ * Striped array of AT24CXX 2-Wire Serial EEPROM devices (max 8 on
+ * the same TWI bus) as a single storage device. Pages are striped
+ * over the devices; consecutive pages are on different devices so
+ * that the page write cycle of one device overlaps with the page
+ * writes to the other devices. The devices must be of the same type
+ * and in deferred write cycle mode (default).
+ * @param[in] N number of devices.
+ * @section Circuit
+ * @code
+ *                         AT24CXX[N]
+ *                       +------------+
+ * (GND/VCC)-----------1-|A0   U   VCC|-8----------------(VCC)
+ * (GND/VCC)-----------2-|A1        WP|-7----------------(GND)
+ * (GND/VCC)-----------3-|A2       SCL|-6----------------(SCL)
+ * (GND)---------------4-|GND      SDA|-5----------------(SDA)
+ *                       +------------+
+ * @endcode
+ */
+template<uint8_t N>
+class AT24CXXArray : public Storage {
+public:
+  /**
+   * Construct striped array of the given devices.
+   * @param[in] dev array of N devices.
+   */
+  AT24CXXArray(AT24CXX* dev[N]) :
+    Storage(dev[0]->SIZE * N),
+    PAGE_MAX(dev[0]->PAGE_MAX)
+  {
+    for (uint8_t i = 0; i < N; i++) m_dev[i] = dev[i];
+  }
+
+  /** Number of bytes in max write page size (per device). */
+  const uint16_t PAGE_MAX;
+
+  /**
+   * Return true(1) if all devices are ready, write cycles are
+   * completed, otherwise false(0).
+   * @return bool.
+   */
+  bool is_ready()
+  {
+    for (uint8_t i = 0; i < N; i++)
+      if (!m_dev[i]->is_ready()) return (false);
+    return (true);
+  }
+
+  /**
+   * Wait for pending page write cycles to complete. Return true(1)
+   * if all devices are ready otherwise false(0) on timeout.
+   * @return bool.
+   */
+  bool sync()
+  {
+    for (uint8_t i = 0; i < N; i++)
+      if (!m_dev[i]->sync()) return (false);
+    return (true);
+  }
+
+  /**
+   * @override{Storage}
+   * Read block with the given size into the buffer from the
+   * address. The read is split on pages and devices. Return number
+   * of bytes read or negative error code.
+   * @param[in] dst buffer to read from eeprom.
+   * @param[in] src address in eeprom to read from.
+   * @param[in] count number of bytes to read.
+   * @return number of bytes or negative error code.
+   */
+  virtual int read(void* dst, uint32_t src, size_t count)
+  {
+    uint8_t* p = (uint8_t*) dst;
+    size_t s = count;
+    while (s != 0) {
+      uint8_t ix;
+      uint32_t addr = map(src, ix);
+      size_t n = PAGE_MAX - (src % PAGE_MAX);
+      if (n > s) n = s;
+      if (m_dev[ix]->read(p, addr, n) < 0) return (-1);
+      src += n;
+      p += n;
+      s -= n;
+    }
+    return (count);
+  }
+
+  /**
+   * @override{Storage}
+   * Write block at given address with the contents from the
+   * buffer. The write is split on pages and devices. Return number of
+   * bytes written or negative error code.
+   * @param[in] dst address in eeprom to write to.
+   * @param[in] src buffer to write to eeprom.
+   * @param[in] count number of bytes to write.
+   * @return number of bytes or negative error code.
+   */
+  virtual int write(uint32_t dst, const void* src, size_t count)
+  {
+    const uint8_t* p = (const uint8_t*) src;
+    size_t s = count;
+    while (s != 0) {
+      uint8_t ix;
+      uint32_t addr = map(dst, ix);
+      size_t n = PAGE_MAX - (dst % PAGE_MAX);
+      if (n > s) n = s;
+      if (m_dev[ix]->write(addr, p, n) < 0) return (-1);
+      dst += n;
+      p += n;
+      s -= n;
+    }
+    return (count);
+  }
+
+protected:
+  /** Devices in array. */
+  AT24CXX* m_dev[N];
+
+  /**
+   * Map given array address to device index and device address.
+   * @param[in] addr array address.
+   * @param[out] ix device index.
+   * @return device address.
+   */
+  uint32_t map(uint32_t addr, uint8_t& ix)
+  {
+    uint32_t page = addr / PAGE_MAX;
+    ix = page % N;
+    return ((page / N) * PAGE_MAX + (addr % PAGE_MAX));
+  }
+};
+#endif
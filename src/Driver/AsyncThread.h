@@ -0,0 +1,186 @@
+/**
+ * @file AsyncThread.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef ASYNC_THREAD_H
+#define ASYNC_THREAD_H
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "Async.h"
+
+/**
+ * Asynchronous request queue with a worker thread (host build). The
+ * worker thread pumps the queue; requests are executed and the
+ * completion callbacks are called on the worker thread. Typically
+ * used with a simulated device (RAM, MMAP or timing model).
+ * @param[in] QUEUE_MAX max number of queued requests (power of 2).
+ */
+template<uint8_t QUEUE_MAX>
+class AsyncThread : public Async::Queue<QUEUE_MAX> {
+public:
+  typedef Async::Queue<QUEUE_MAX> Queue;
+  typedef Async::Request Request;
+
+  /**
+   * Construct request queue on given storage device and start the
+   * worker thread.
+   * @param[in] dev storage device.
+   */
+  AsyncThread(Storage& dev) :
+    Queue(dev),
+    m_running(true),
+    m_thread(&AsyncThread::run, this)
+  {
+  }
+
+  /**
+   * Execute queued requests, stop and join the worker thread.
+   */
+  ~AsyncThread()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_running = false;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+  }
+
+  /**
+   * @override{Async::Queue}
+   * Submit request to read given number of bytes from storage
+   * address to buffer and wake the worker thread. Returns zero if
+   * queued otherwise negative error code.
+   * @param[in] req request.
+   * @param[in] dst destination buffer pointer.
+   * @param[in] src source memory address on device.
+   * @param[in] count number of bytes to read from device.
+   * @return zero or negative error code.
+   */
+  int read(Request& req, void* dst, uint32_t src, size_t count)
+  {
+    int res;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      res = Queue::read(req, dst, src, count);
+    }
+    m_cond.notify_all();
+    return (res);
+  }
+
+  /**
+   * @override{Async::Queue}
+   * Submit request to write given number of bytes from buffer to
+   * storage address and wake the worker thread. Returns zero if
+   * queued otherwise negative error code.
+   * @param[in] req request.
+   * @param[in] dst destination memory address on device.
+   * @param[in] src source buffer pointer.
+   * @param[in] count number of bytes to write to device.
+   * @return zero or negative error code.
+   */
+  int write(Request& req, uint32_t dst, const void* src, size_t count)
+  {
+    int res;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      res = Queue::write(req, dst, src, count);
+    }
+    m_cond.notify_all();
+    return (res);
+  }
+
+  /**
+   * @override{Async::Queue}
+   * The queue is pumped by the worker thread. Returns false(0).
+   * @return bool.
+   */
+  bool pump()
+  {
+    return (false);
+  }
+
+  /**
+   * @override{Async::Queue}
+   * Wait for the worker thread to execute all queued requests.
+   */
+  void flush()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this] {
+	return ((this->m_put == this->m_get) && !this->m_busy);
+      });
+  }
+
+  /**
+   * @override{Async::Queue}
+   * Wait for given request to complete. Returns request result.
+   * @param[in] req request.
+   * @return number of bytes or negative error code.
+   */
+  int wait(Request& req)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [&req] { return (req.is_done()); });
+    return (req.res);
+  }
+
+protected:
+  /** Worker thread is running. */
+  bool m_running;
+
+  /** Queue and request state lock. */
+  std::mutex m_mutex;
+
+  /** Queue and request state change. */
+  std::condition_variable m_cond;
+
+  /** Worker thread. */
+  std::thread m_thread;
+
+  /**
+   * Worker thread; execute requests until stopped and the queue is
+   * empty. Queue and request state is only modified while holding
+   * the lock. The device is accessed and the completion callback is
+   * called without holding the lock.
+   */
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (1) {
+      m_cond.wait(lock, [this] {
+	  return (!m_running || (this->m_put != this->m_get));
+	});
+      if (this->m_put == this->m_get) break;
+      Request& req = *this->m_queue[this->m_get & Queue::MASK];
+      this->m_busy = true;
+      lock.unlock();
+      this->execute(req);
+      lock.lock();
+      this->m_get += 1;
+      Queue::done(req);
+      lock.unlock();
+      Queue::notify(req);
+      lock.lock();
+      this->m_busy = false;
+      m_cond.notify_all();
+    }
+  }
+};
+#endif
@@ -43,9 +43,31 @@ public:
    */
   MC23LCXXX(SPI& spi) :
     Storage(KBYTE * 1024UL),
-    SPI::Device<0, MSBFIRST, FREQ, SS_PIN>(spi)
+    SPI::Device<0, MSBFIRST, FREQ, SS_PIN>(spi),
+    m_sequential(false)
   {}
 
+  /**
+   * Set device in sequential mode with the write mode register and
+   * verify with the read mode register. Called by read(), write()
+   * and Session when the mode has not yet been set. Returns true(1)
+   * if successful otherwise false(0).
+   * @return bool.
+   */
+  bool begin()
+  {
+    acquire();
+    transfer(WRMR);
+    transfer(SEQUENTIAL_MODE);
+    release();
+    acquire();
+    transfer(RDMR);
+    uint8_t mode = transfer(0);
+    release();
+    m_sequential = ((mode & MODE_MASK) == SEQUENTIAL_MODE);
+    return (m_sequential);
+  }
+
   /**
    * @override{Storage}
    * Read given count number of bytes from SRAM source address to
@@ -58,21 +80,9 @@ public:
    */
   virtual int read(void* dst, uint32_t src, size_t count)
   {
-    uint8_t* sp = (uint8_t*) &src;
+    if (!m_sequential && !begin()) return (-1);
     header_t header;
-    size_t size;
-    header.cmd = READ;
-    if (KBYTE > 64) {
-      header.addr[0] = sp[2];
-      header.addr[1] = sp[1];
-      header.addr[2] = sp[0];
-      size = sizeof(header);
-    }
-    else {
-      header.addr[0] = sp[1];
-      header.addr[1] = sp[0];
-      size = sizeof(header) - 1;
-    }
+    size_t size = header_init(header, READ, src);
     acquire();
     write(&header, size);
     read(dst, count);
@@ -92,21 +102,9 @@ public:
    */
   virtual int write(uint32_t dst, const void* src, size_t count)
   {
-    uint8_t* dp = (uint8_t*) &dst;
+    if (!m_sequential && !begin()) return (-1);
     header_t header;
-    size_t size;
-    header.cmd = WRITE;
-    if (KBYTE > 64) {
-      header.addr[0] = dp[2];
-      header.addr[1] = dp[1];
-      header.addr[2] = dp[0];
-      size = sizeof(header);
-    }
-    else {
-      header.addr[0] = dp[1];
-      header.addr[1] = dp[0];
-      size = sizeof(header) - 1;
-    }
+    size_t size = header_init(header, WRITE, dst);
     acquire();
     write(&header, size);
     write(src, count);
@@ -114,6 +112,135 @@ public:
     return (count);
   }
 
+  /**
+   * @override{Storage}
+   * Read given number of segments from SRAM to the segment buffers
+   * in a single session. Adjacent segments are read without a new
+   * header. Returns number of bytes read or negative error code.
+   * @param[in] vec segment vector.
+   * @param[in] count number of segments.
+   * @return number of bytes read or negative error code.
+   */
+  virtual int readv(const vec_t* vec, size_t count);
+
+  /**
+   * @override{Storage}
+   * Write given number of segments from the segment buffers to SRAM
+   * in a single session. Adjacent segments are written without a new
+   * header. Returns number of bytes written or negative error code.
+   * @param[in] vec segment vector.
+   * @param[in] count number of segments.
+   * @return number of bytes written or negative error code.
+   */
+  virtual int writev(const vec_t* vec, size_t count);
+
+  /**
+   * Device session; acquires the device once for a sequence of read
+   * and write operations. An operation that continues at the next
+   * address in the same direction as the previous operation is
+   * transferred in the open sequential mode transfer without a new
+   * command and address header. Other operations restart the
+   * transfer. The bus is held until the session is closed or
+   * destructed; other devices on the bus, and the driver read() and
+   * write(), may not be used within the session.
+   */
+  class Session {
+  public:
+    /**
+     * Construct session on given device.
+     * @param[in] dev device driver.
+     */
+    Session(MC23LCXXX& dev) :
+      m_dev(dev),
+      m_cmd(0),
+      m_addr(0)
+    {
+    }
+
+    /**
+     * Close session and destruct.
+     */
+    ~Session()
+    {
+      close();
+    }
+
+    /**
+     * Read given count number of bytes from SRAM source address to
+     * destination buffer. Returns number of bytes read, or negative
+     * error code.
+     * @param[in] dst destination buffer pointer.
+     * @param[in] src source memory address on device.
+     * @param[in] count number of bytes to read from device.
+     * @return number of bytes read or negative error code.
+     */
+    int read(void* dst, uint32_t src, size_t count)
+    {
+      if (!open(READ, src)) return (-1);
+      m_dev.read(dst, count);
+      m_addr = (src + count) & (m_dev.SIZE - 1);
+      return (count);
+    }
+
+    /**
+     * Write given count number of bytes to SRAM destination address
+     * from source buffer. Returns number of bytes written, or
+     * negative error code.
+     * @param[in] dst destination memory address on device.
+     * @param[in] src source buffer pointer.
+     * @param[in] count number of bytes to write to device.
+     * @return number of bytes written or negative error code.
+     */
+    int write(uint32_t dst, const void* src, size_t count)
+    {
+      if (!open(WRITE, dst)) return (-1);
+      m_dev.write(src, count);
+      m_addr = (dst + count) & (m_dev.SIZE - 1);
+      return (count);
+    }
+
+    /**
+     * Close the open transfer and release the device.
+     */
+    void close()
+    {
+      if (m_cmd == 0) return;
+      m_dev.release();
+      m_cmd = 0;
+    }
+
+  protected:
+    /** Device driver. */
+    MC23LCXXX& m_dev;
+
+    /** Command of open transfer, zero if closed. */
+    uint8_t m_cmd;
+
+    /** Address of next byte in open transfer. */
+    uint32_t m_addr;
+
+    /**
+     * Continue open transfer if the given command and address match
+     * otherwise restart transfer with command and address
+     * header. Returns true(1) if successful otherwise false(0).
+     * @param[in] cmd command code.
+     * @param[in] addr memory address on device.
+     * @return bool.
+     */
+    bool open(uint8_t cmd, uint32_t addr)
+    {
+      if ((m_cmd == cmd) && (m_addr == addr)) return (true);
+      close();
+      if (!m_dev.m_sequential && !m_dev.begin()) return (false);
+      header_t header;
+      size_t size = m_dev.header_init(header, cmd, addr);
+      m_dev.acquire();
+      m_dev.write(&header, size);
+      m_cmd = cmd;
+      return (true);
+    }
+  };
+
 protected:
   /** Command and address header. */
   struct header_t {
@@ -129,6 +256,39 @@ protected:
     WRMR = 0x01			//!< Write mode register
   };
 
+  /** Mode register. */
+  enum {
+    SEQUENTIAL_MODE = 0x40,	//!< Sequential mode
+    MODE_MASK = 0xc0		//!< Mode bits mask
+  };
+
+  /** Device in sequential mode. */
+  bool m_sequential;
+
+  /**
+   * Initiate given header with command and address. Returns size of
+   * header; 24-bit address for devices larger than 64 Kbyte
+   * otherwise 16-bit.
+   * @param[in] header to initiate.
+   * @param[in] cmd command code.
+   * @param[in] addr memory address on device.
+   * @return number of bytes in header.
+   */
+  size_t header_init(header_t& header, uint8_t cmd, uint32_t addr)
+  {
+    uint8_t* ap = (uint8_t*) &addr;
+    header.cmd = cmd;
+    if (KBYTE > 64) {
+      header.addr[0] = ap[2];
+      header.addr[1] = ap[1];
+      header.addr[2] = ap[0];
+      return (sizeof(header));
+    }
+    header.addr[0] = ap[1];
+    header.addr[1] = ap[0];
+    return (sizeof(header) - 1);
+  }
+
   using SPI::Device<0,MSBFIRST,FREQ,SS_PIN>::acquire;
   using SPI::Device<0,MSBFIRST,FREQ,SS_PIN>::transfer;
   using SPI::Device<0,MSBFIRST,FREQ,SS_PIN>::read;
@@ -136,6 +296,32 @@ protected:
   using SPI::Device<0,MSBFIRST,FREQ,SS_PIN>::release;
 };
 
+template<uint16_t KBYTE, BOARD::pin_t SS_PIN, uint32_t FREQ>
+int
+MC23LCXXX<KBYTE, SS_PIN, FREQ>::readv(const vec_t* vec, size_t count)
+{
+  Session session(*this);
+  int res = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (session.read(vec[i].buf, vec[i].addr, vec[i].size) < 0) return (-1);
+    res += vec[i].size;
+  }
+  return (res);
+}
+
+template<uint16_t KBYTE, BOARD::pin_t SS_PIN, uint32_t FREQ>
+int
+MC23LCXXX<KBYTE, SS_PIN, FREQ>::writev(const vec_t* vec, size_t count)
+{
+  Session session(*this);
+  int res = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (session.write(vec[i].addr, vec[i].buf, vec[i].size) < 0) return (-1);
+    res += vec[i].size;
+  }
+  return (res);
+}
+
 /**
  * Storage device driver for Microchip 23LC512, 512 Kbit SPI Serial
  * SRAM.
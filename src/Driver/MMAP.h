@@ -0,0 +1,126 @@
+/**
+ * @file MMAP.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef MMAP_H
+#define MMAP_H
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Driver/RAM.h"
+
+/**
+ * Storage device driver for a memory mapped file (POSIX host
+ * build). The file is created, or extended, to the given size and
+ * mapped shared so that the contents persist between runs.
+ */
+class MMAP : public RAM {
+public:
+  /**
+   * Construct storage device driver on the file with the given path
+   * name and number of bytes. Use is_open() to check that the file
+   * was mapped.
+   * @param[in] path file path name.
+   * @param[in] size number of bytes in file.
+   */
+  MMAP(const char* path, uint32_t size) :
+    RAM(NULL, size),
+    m_fd(open(path, O_RDWR | O_CREAT, 0644))
+  {
+    struct stat st;
+    if (m_fd < 0) return;
+    if ((fstat(m_fd, &st) < 0)
+	|| ((st.st_size < (off_t) size) && (ftruncate(m_fd, size) < 0))) {
+      close(m_fd);
+      m_fd = -1;
+      return;
+    }
+    void* buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (buf != MAP_FAILED) m_buf = (uint8_t*) buf;
+  }
+
+  /**
+   * Write back, unmap and close file.
+   */
+  ~MMAP()
+  {
+    if (m_buf != NULL) {
+      sync();
+      munmap(m_buf, SIZE);
+    }
+    if (m_fd >= 0) close(m_fd);
+  }
+
+  /**
+   * Return true(1) if the file is mapped otherwise false(0).
+   * @return bool.
+   */
+  bool is_open()
+  {
+    return (m_buf != NULL);
+  }
+
+  /**
+   * Write back modified pages to the file. Returns zero if
+   * successful otherwise negative error code.
+   * @return zero or negative error code.
+   */
+  int sync()
+  {
+    if (m_buf == NULL) return (-1);
+    return (msync(m_buf, SIZE, MS_SYNC));
+  }
+
+  /**
+   * @override{Storage}
+   * Read given count number of bytes from file source address to
+   * destination buffer. Returns number of bytes read, or negative
+   * error code.
+   * @param[in] dst destination buffer pointer.
+   * @param[in] src source memory address on device.
+   * @param[in] count number of bytes to read from device.
+   * @return number of bytes read or negative error code.
+   */
+  virtual int read(void* dst, uint32_t src, size_t count)
+  {
+    if (m_buf == NULL) return (-1);
+    return (RAM::read(dst, src, count));
+  }
+
+  /**
+   * @override{Storage}
+   * Write given count number of bytes to file destination address
+   * from source buffer. Returns number of bytes written, or negative
+   * error code.
+   * @param[in] dst destination memory address on device.
+   * @param[in] src source buffer pointer.
+   * @param[in] count number of bytes to write to device.
+   * @return number of bytes written or negative error code.
+   */
+  virtual int write(uint32_t dst, const void* src, size_t count)
+  {
+    if (m_buf == NULL) return (-1);
+    return (RAM::write(dst, src, count));
+  }
+
+protected:
+  /** File descriptor. */
+  int m_fd;
+};
+#endif
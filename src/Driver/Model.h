@@ -0,0 +1,287 @@
+/**
+ * @file Model.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef MODEL_H
+#define MODEL_H
+
+#include "Storage.h"
+
+/**
+ * Abstract device timing model. Wraps a backing storage device
+ * (typically RAM or MMAP) and accumulates the bus and device time
+ * the modelled device would have used on a simulated clock. The
+ * simulated clock is deterministic and independent of the host.
+ */
+class Model : public Storage {
+public:
+  /**
+   * Construct timing model on the given backing storage device.
+   * @param[in] dev backing storage device.
+   */
+  Model(Storage& dev) :
+    Storage(dev.SIZE),
+    m_dev(dev),
+    m_ns(0)
+  {}
+
+  /**
+   * Returns simulated time in micro-seconds.
+   * @return micro-seconds.
+   */
+  uint32_t elapsed()
+  {
+    return (m_ns / 1000);
+  }
+
+  /**
+   * Advance simulated time with the given number of micro-seconds.
+   * Used to model application processing between device operations.
+   * @param[in] us micro-seconds.
+   */
+  void idle(uint32_t us)
+  {
+    m_ns += us * 1000ULL;
+  }
+
+  /**
+   * Reset simulated time.
+   */
+  virtual void reset()
+  {
+    m_ns = 0;
+  }
+
+protected:
+  /** Backing storage device. */
+  Storage& m_dev;
+
+  /** Simulated time in nano-seconds. */
+  uint64_t m_ns;
+};
+
+/**
+ * Timing model of AT24CXX 2-Wire Serial EEPROM and driver. Each
+ * TWI byte costs nine bit times. Writes are split on pages and each
+ * page starts an internal write cycle. Operations during the write
+ * cycle are delayed by the driver acknowledge polling; failed
+ * address byte and poll delay.
+ */
+class AT24CXXModel : public Model {
+public:
+  /**
+   * Construct timing model on given backing storage device with the
+   * given bus frequency, page size, write cycle time, poll delay and
+   * per transaction overhead.
+   * @param[in] dev backing storage device.
+   * @param[in] freq bus frequency in Hz (default 400 kHz).
+   * @param[in] page_max size of memory page (default 32 byte).
+   * @param[in] t_wr write cycle time in us (default 5 ms).
+   * @param[in] t_retry driver poll delay in us (default 1 ms; the
+   * AT24CXX driver POLL_DELAY_US is 100 us).
+   * @param[in] t_overhead transaction overhead in us (default 50 us).
+   */
+  AT24CXXModel(Storage& dev,
+	       uint32_t freq = 400000UL,
+	       uint16_t page_max = 32,
+	       uint16_t t_wr = 5000,
+	       uint16_t t_retry = 1000,
+	       uint16_t t_overhead = 50) :
+    Model(dev),
+    PAGE_MAX(page_max),
+    PAGE_MASK(page_max - 1),
+    BYTE_NS(9000000000ULL / freq),
+    T_WR(t_wr),
+    T_RETRY(t_retry),
+    T_OVERHEAD(t_overhead),
+    m_ready(0)
+  {}
+
+  /** Number of bytes in max write page size. */
+  const uint16_t PAGE_MAX;
+
+  /**
+   * Return true(1) if the modelled write cycle is completed,
+   * otherwise false(0).
+   * @return bool.
+   */
+  bool is_ready()
+  {
+    return (m_ns >= m_ready);
+  }
+
+  /**
+   * Account for waiting for the modelled write cycle to complete.
+   * Return true(1).
+   * @return bool.
+   */
+  bool sync()
+  {
+    wait();
+    return (true);
+  }
+
+  /**
+   * @override{Model}
+   * Reset simulated time and write cycle.
+   */
+  virtual void reset()
+  {
+    Model::reset();
+    m_ready = 0;
+  }
+
+  /**
+   * @override{Storage}
+   * Read block with given size into the buffer from the address
+   * and account for device address, memory address and data bytes.
+   * Return number of bytes read or negative error code.
+   * @param[in] dst buffer to read from eeprom.
+   * @param[in] src address in eeprom to read from.
+   * @param[in] count number of bytes to read.
+   * @return number of bytes or negative error code.
+   */
+  virtual int read(void* dst, uint32_t src, size_t count)
+  {
+    wait();
+    m_ns += T_OVERHEAD * 1000ULL + (4 + count) * BYTE_NS;
+    return (m_dev.read(dst, src, count));
+  }
+
+  /**
+   * @override{Storage}
+   * Write block at given address with the contents from the buffer
+   * and account for page writes and write cycles. Return number of
+   * bytes written or negative error code.
+   * @param[in] dst address in eeprom to read write to.
+   * @param[in] src buffer to write to eeprom.
+   * @param[in] count number of bytes to write.
+   * @return number of bytes or negative error code.
+   */
+  virtual int write(uint32_t dst, const void* src, size_t count)
+  {
+    size_t s = count;
+    size_t n = PAGE_MAX - (dst & PAGE_MASK);
+    if (n > s) n = s;
+    while (s != 0) {
+      wait();
+      m_ns += T_OVERHEAD * 1000ULL + (3 + n) * BYTE_NS;
+      m_ready = m_ns + T_WR * 1000ULL;
+      s -= n;
+      n = (s < PAGE_MAX ? s : PAGE_MAX);
+    }
+    return (m_dev.write(dst, src, count));
+  }
+
+protected:
+  /** Memory address page mask. */
+  const uint16_t PAGE_MASK;
+
+  /** Time per byte on bus in nano-seconds. */
+  const uint32_t BYTE_NS;
+
+  /** Write cycle time in micro-seconds. */
+  const uint16_t T_WR;
+
+  /** Driver poll delay in micro-seconds. */
+  const uint16_t T_RETRY;
+
+  /** Transaction overhead in micro-seconds. */
+  const uint16_t T_OVERHEAD;
+
+  /** Simulated time when write cycle is completed. */
+  uint64_t m_ready;
+
+  /**
+   * Account for driver acknowledge polling (not acknowledged address
+   * byte and poll delay) while the device is in write cycle.
+   */
+  void wait()
+  {
+    while (m_ns < m_ready)
+      m_ns += T_OVERHEAD * 1000ULL + BYTE_NS + T_RETRY * 1000ULL;
+  }
+};
+
+/**
+ * Timing model of Microchip 23LCXXX, SPI Serial SRAM and driver.
+ * Each transaction costs the per transaction overhead, the command
+ * and address header, and data bytes.
+ */
+class MC23LCXXXModel : public Model {
+public:
+  /**
+   * Construct timing model on given backing storage device with the
+   * given bus frequency and per transaction overhead. The address
+   * header is 24-bit for devices larger than 64 Kbyte otherwise
+   * 16-bit.
+   * @param[in] dev backing storage device.
+   * @param[in] freq bus frequency in Hz (default 8 MHz).
+   * @param[in] t_overhead transaction overhead in us (default 16 us).
+   */
+  MC23LCXXXModel(Storage& dev,
+		 uint32_t freq = 8000000UL,
+		 uint16_t t_overhead = 16) :
+    Model(dev),
+    HEADER_MAX(dev.SIZE > 0x10000UL ? 4 : 3),
+    BYTE_NS(8000000000ULL / freq),
+    T_OVERHEAD(t_overhead)
+  {}
+
+  /**
+   * @override{Storage}
+   * Read given count number of bytes from source address to
+   * destination buffer and account for header and data transfer.
+   * Returns number of bytes read, or negative error code.
+   * @param[in] dst destination buffer pointer.
+   * @param[in] src source memory address on device.
+   * @param[in] count number of bytes to read from device.
+   * @return number of bytes read or negative error code.
+   */
+  virtual int read(void* dst, uint32_t src, size_t count)
+  {
+    m_ns += T_OVERHEAD * 1000ULL + (HEADER_MAX + count) * BYTE_NS;
+    return (m_dev.read(dst, src, count));
+  }
+
+  /**
+   * @override{Storage}
+   * Write given count number of bytes to destination address from
+   * source buffer and account for header and data transfer. Returns
+   * number of bytes written, or negative error code.
+   * @param[in] dst destination memory address on device.
+   * @param[in] src source buffer pointer.
+   * @param[in] count number of bytes to write to device.
+   * @return number of bytes written or negative error code.
+   */
+  virtual int write(uint32_t dst, const void* src, size_t count)
+  {
+    m_ns += T_OVERHEAD * 1000ULL + (HEADER_MAX + count) * BYTE_NS;
+    return (m_dev.write(dst, src, count));
+  }
+
+protected:
+  /** Number of bytes in command and address header. */
+  const uint8_t HEADER_MAX;
+
+  /** Time per byte on bus in nano-seconds. */
+  const uint32_t BYTE_NS;
+
+  /** Transaction overhead in micro-seconds. */
+  const uint16_t T_OVERHEAD;
+};
+#endif
@@ -0,0 +1,250 @@
+/**
+ * @file Probe.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef PROBE_H
+#define PROBE_H
+
+#include "Storage.h"
+
+/**
+ * Storage instrumentation. Wraps a storage device and counts calls,
+ * bytes and failures, and records a latency histogram (log2 micro-
+ * seconds buckets) per operation type, and calls per address
+ * region. Blocks, caches and streams should be allocated on the
+ * probe instead of the device; the region counters show the hot
+ * blocks and streams. The probe is removed at compile-time by using
+ * the device directly. The STORAGE_STATS symbol also enables the
+ * device driver counters (e.g. AT24CXX retries and write cycle
+ * waits), e.g.
+ * @code
+ * #if defined(STORAGE_STATS)
+ * Probe probe(eeprom);
+ * Storage& storage = probe;
+ * #else
+ * Storage& storage = eeprom;
+ * #endif
+ * @endcode
+ */
+class Probe : public Storage {
+public:
+  /** Operation types. */
+  enum {
+    READ = 0,			//!< read() and readv().
+    WRITE = 1,			//!< write() and writev().
+    OP_MAX = 2			//!< Number of operation types.
+  };
+
+  /** Number of latency histogram buckets; last is open ended. */
+  static const uint8_t BUCKET_MAX = 16;
+
+  /** Number of address regions. */
+  static const uint8_t REGION_MAX = 8;
+
+  /** Operation statistics. */
+  struct stats_t {
+    uint32_t calls;		//!< Number of calls.
+    uint32_t bytes;		//!< Number of bytes transferred.
+    uint32_t failures;		//!< Number of failed calls.
+    uint32_t histogram[BUCKET_MAX]; //!< Calls per log2 us latency.
+  };
+
+  /**
+   * Construct probe on the given storage device.
+   * @param[in] dev storage device.
+   */
+  Probe(Storage& dev) :
+    Storage(dev.SIZE),
+    m_dev(dev)
+  {
+    reset();
+  }
+
+  /**
+   * Returns statistics for the given operation type, or empty
+   * statistics if the operation type is unknown.
+   * @param[in] op operation type (READ or WRITE).
+   * @return statistics.
+   */
+  const stats_t& stats(uint8_t op)
+  {
+    static const stats_t none = {};
+    if (op >= OP_MAX) return (none);
+    return (m_stats[op]);
+  }
+
+  /**
+   * Returns number of calls that accessed the given address region,
+   * or zero if the region is out of range. Each region is SIZE /
+   * REGION_MAX bytes.
+   * @param[in] region address region.
+   * @return number of calls.
+   */
+  uint32_t region(uint8_t region)
+  {
+    if (region >= REGION_MAX) return (0);
+    return (m_region[region]);
+  }
+
+  /**
+   * Reset statistics.
+   */
+  void reset()
+  {
+    memset(m_stats, 0, sizeof(m_stats));
+    memset(m_region, 0, sizeof(m_region));
+  }
+
+  /**
+   * Print statistics to the given output stream. One line per
+   * operation type with counters and non-zero histogram buckets
+   * (bucket upper bound in micro-seconds; lower bound for the last,
+   * open ended, bucket), and a line with calls per address region.
+   * @param[in] out output stream.
+   */
+  void dump(Print& out)
+  {
+    for (uint8_t op = 0; op < OP_MAX; op++) {
+      stats_t& stats = m_stats[op];
+      out.print(op == READ ? F("read") : F("write"));
+      out.print(F(": calls = "));
+      out.print(stats.calls);
+      out.print(F(", bytes = "));
+      out.print(stats.bytes);
+      out.print(F(", failures = "));
+      out.print(stats.failures);
+      out.print(F(", us ="));
+      for (uint8_t i = 0; i < BUCKET_MAX; i++) {
+	if (stats.histogram[i] == 0) continue;
+	out.print(' ');
+	if (i == BUCKET_MAX - 1)
+	  out.print(F(">="));
+	else
+	  out.print('<');
+	out.print(1UL << (i == BUCKET_MAX - 1 ? i - 1 : i));
+	out.print(':');
+	out.print(stats.histogram[i]);
+      }
+      out.println();
+    }
+    out.print(F("region:"));
+    for (uint8_t i = 0; i < REGION_MAX; i++) {
+      out.print(' ');
+      out.print(m_region[i]);
+    }
+    out.println();
+  }
+
+  /**
+   * @override{Storage}
+   * Read from storage device and record statistics.
+   * @param[in] dst destination buffer pointer.
+   * @param[in] src source memory address on device.
+   * @param[in] count number of bytes to read from device.
+   * @return number of bytes read or negative error code.
+   */
+  virtual int read(void* dst, uint32_t src, size_t count)
+  {
+    uint32_t start = micros();
+    int res = m_dev.read(dst, src, count);
+    record(READ, src, res, start);
+    return (res);
+  }
+
+  /**
+   * @override{Storage}
+   * Write to storage device and record statistics.
+   * @param[in] dst destination memory address on device.
+   * @param[in] src source buffer pointer.
+   * @param[in] count number of bytes to write to device.
+   * @return number of bytes written or negative error code.
+   */
+  virtual int write(uint32_t dst, const void* src, size_t count)
+  {
+    uint32_t start = micros();
+    int res = m_dev.write(dst, src, count);
+    record(WRITE, dst, res, start);
+    return (res);
+  }
+
+  /**
+   * @override{Storage}
+   * Read segments from storage device and record statistics.
+   * @param[in] vec segment vector.
+   * @param[in] count number of segments.
+   * @return number of bytes read or negative error code.
+   */
+  virtual int readv(const vec_t* vec, size_t count)
+  {
+    uint32_t start = micros();
+    int res = m_dev.readv(vec, count);
+    record(READ, count != 0 ? vec[0].addr : 0, res, start);
+    return (res);
+  }
+
+  /**
+   * @override{Storage}
+   * Write segments to storage device and record statistics.
+   * @param[in] vec segment vector.
+   * @param[in] count number of segments.
+   * @return number of bytes written or negative error code.
+   */
+  virtual int writev(const vec_t* vec, size_t count)
+  {
+    uint32_t start = micros();
+    int res = m_dev.writev(vec, count);
+    record(WRITE, count != 0 ? vec[0].addr : 0, res, start);
+    return (res);
+  }
+
+protected:
+  /** Storage device. */
+  Storage& m_dev;
+
+  /** Statistics per operation type. */
+  stats_t m_stats[OP_MAX];
+
+  /** Calls per address region. */
+  uint32_t m_region[REGION_MAX];
+
+  /**
+   * Record operation result and latency.
+   * @param[in] op operation type.
+   * @param[in] addr device address.
+   * @param[in] res operation result.
+   * @param[in] start operation start time (us).
+   */
+  void record(uint8_t op, uint32_t addr, int res, uint32_t start)
+  {
+    uint32_t us = micros() - start;
+    stats_t& stats = m_stats[op];
+    stats.calls += 1;
+    if (res < 0)
+      stats.failures += 1;
+    else
+      stats.bytes += res;
+    uint8_t i = 0;
+    while ((us != 0) && (i < BUCKET_MAX - 1)) {
+      us >>= 1;
+      i += 1;
+    }
+    stats.histogram[i] += 1;
+    if (addr < SIZE)
+      m_region[addr / ((SIZE + REGION_MAX - 1) / REGION_MAX)] += 1;
+  }
+};
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file RAM.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef RAM_H
+#define RAM_H
+
+#include "Storage.h"
+
+/**
+ * Storage device driver for a memory buffer. Allows the Storage
+ * classes to be used without external hardware, e.g. in host builds
+ * or as backing store for the device timing models.
+ */
+class RAM : public Storage {
+public:
+  /**
+   * Construct storage device driver on the given buffer and number
+   * of bytes.
+   * @param[in] buf memory buffer.
+   * @param[in] size number of bytes in buffer.
+   */
+  RAM(void* buf, uint32_t size) :
+    Storage(size),
+    m_buf((uint8_t*) buf)
+  {}
+
+  /**
+   * Returns pointer to memory buffer.
+   * @return buffer pointer.
+   */
+  uint8_t* buf()
+  {
+    return (m_buf);
+  }
+
+  /**
+   * @override{Storage}
+   * Read given count number of bytes from source address to
+   * destination buffer. Returns number of bytes read, or negative
+   * error code.
+   * @param[in] dst destination buffer pointer.
+   * @param[in] src source memory address on device.
+   * @param[in] count number of bytes to read from device.
+   * @return number of bytes read or negative error code.
+   */
+  virtual int read(void* dst, uint32_t src, size_t count)
+  {
+    if (src + count > SIZE) return (-1);
+    memcpy(dst, m_buf + src, count);
+    return (count);
+  }
+
+  /**
+   * @override{Storage}
+   * Write given count number of bytes to destination address from
+   * source buffer. Returns number of bytes written, or negative
+   * error code.
+   * @param[in] dst destination memory address on device.
+   * @param[in] src source buffer pointer.
+   * @param[in] count number of bytes to write to device.
+   * @return number of bytes written or negative error code.
+   */
+  virtual int write(uint32_t dst, const void* src, size_t count)
+  {
+    if (dst + count > SIZE) return (-1);
+    memcpy(m_buf + dst, src, count);
+    return (count);
+  }
+
+protected:
+  /** Memory buffer. */
+  uint8_t* m_buf;
+};
+#endif
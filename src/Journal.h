@@ -0,0 +1,245 @@
+/**
+ * @file Journal.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "Storage.h"
+
+/**
+ * Log-structured persistent record. Each write appends a new copy of
+ * the record, with sequence number and checksum (CRC-16/CCITT), to
+ * the next slot in the block (round-robin) so that writes are spread
+ * over all slots. Read recovers the newest valid copy; a torn or
+ * corrupted copy is skipped for the previous copy. Sequence numbers
+ * 0x0000 and 0xffff are never written (erased or cleared storage).
+ */
+class Journal : public Storage::Block {
+public:
+  /**
+   * Construct journal on given storage device with the given local
+   * record buffer, record size and number of slots.
+   * @param[in] mem storage device for journal.
+   * @param[in] buf record buffer address.
+   * @param[in] size number of bytes per record.
+   * @param[in] nmemb number of slots (max 0x7fff).
+   */
+  Journal(Storage &mem, void* buf, size_t size, size_t nmemb) :
+    Block(mem, (sizeof(header_t) + size) * nmemb),
+    MSIZE(size),
+    NMEMB(nmemb),
+    m_buf(buf),
+    m_slot(nmemb - 1),
+    m_seq(0)
+  {
+  }
+
+  /**
+   * Read newest valid record copy to buffer. The slot headers are
+   * scanned for the newest sequence number and the copy is verified
+   * with the checksum. Returns number of bytes read or negative
+   * error code if there is no valid copy (buffer is undefined).
+   * @return number of bytes read or negative error code.
+   */
+  int read()
+  {
+    uint16_t limit = 0;
+    while (1) {
+      header_t header;
+      size_t slot = NMEMB;
+      uint16_t seq = 0;
+      for (size_t i = 0; i < NMEMB; i++) {
+	if (m_mem.read(&header, addr(i), sizeof(header)) < 0) return (-1);
+	if (!is_valid(header.seq)) continue;
+	if ((limit != 0) && !is_newer(limit, header.seq)) continue;
+	if ((slot == NMEMB) || is_newer(header.seq, seq)) {
+	  slot = i;
+	  seq = header.seq;
+	}
+      }
+      if (slot == NMEMB) return (-1);
+      if (m_mem.read(&header, addr(slot), sizeof(header)) < 0) return (-1);
+      if (m_mem.read(m_buf, addr(slot) + sizeof(header), MSIZE) < 0)
+	return (-1);
+      if (header.crc == crc(header.seq)) {
+	m_slot = slot;
+	m_seq = seq;
+	return (MSIZE);
+      }
+      limit = seq;
+    }
+  }
+
+  /**
+   * Append buffer as a new record copy in the next slot. If there is
+   * no current record copy (write before read) the slot headers are
+   * scanned first so that the new copy is the newest. Returns number
+   * of bytes written or negative error code.
+   * @return number of bytes written or negative error code.
+   */
+  int write()
+  {
+    if ((m_seq == 0) && (recover() < 0)) return (-1);
+    size_t slot = m_slot + 1;
+    if (slot == NMEMB) slot = 0;
+    header_t header;
+    header.seq = m_seq + 1;
+    if (!is_valid(header.seq)) header.seq = 1;
+    header.crc = crc(header.seq);
+    Storage::vec_t vec[2];
+    vec[0].addr = addr(slot);
+    vec[0].buf = &header;
+    vec[0].size = sizeof(header);
+    vec[1].addr = addr(slot) + sizeof(header);
+    vec[1].buf = m_buf;
+    vec[1].size = MSIZE;
+    if (m_mem.writev(vec, 2) < 0) return (-1);
+    m_slot = slot;
+    m_seq = header.seq;
+    return (MSIZE);
+  }
+
+  /**
+   * Returns storage address of the indexed slot. Default index is
+   * the first slot.
+   * @param[in] slot index (default 0).
+   * @return address.
+   */
+  uint32_t addr(size_t slot = 0)
+  {
+    return (m_addr + (slot * (sizeof(header_t) + MSIZE)));
+  }
+
+  /**
+   * Returns sequence number of the current record copy, zero if
+   * none.
+   * @return sequence number.
+   */
+  uint16_t seq()
+  {
+    return (m_seq);
+  }
+
+  /**
+   * Returns slot of the current record copy.
+   * @return slot index.
+   */
+  size_t slot()
+  {
+    return (m_slot);
+  }
+
+  /** Size of record. */
+  const size_t MSIZE;
+
+  /** Number of slots. */
+  const size_t NMEMB;
+
+protected:
+  /** Slot header. */
+  struct header_t {
+    uint16_t seq;		//!< Sequence number.
+    uint16_t crc;		//!< Checksum of sequence number and record.
+  };
+
+  /** Record buffer. */
+  void* m_buf;
+
+  /** Slot of current record copy. */
+  size_t m_slot;
+
+  /** Sequence number of current record copy. */
+  uint16_t m_seq;
+
+  /**
+   * Scan slot headers for the newest sequence number, without
+   * verifying the record copy, and set current slot and sequence
+   * number. The record buffer is not modified. Returns zero or
+   * negative error code.
+   * @return zero or negative error code.
+   */
+  int recover()
+  {
+    header_t header;
+    for (size_t i = 0; i < NMEMB; i++) {
+      if (m_mem.read(&header, addr(i), sizeof(header)) < 0) return (-1);
+      if (!is_valid(header.seq)) continue;
+      if ((m_seq == 0) || is_newer(header.seq, m_seq)) {
+	m_slot = i;
+	m_seq = header.seq;
+      }
+    }
+    return (0);
+  }
+
+  /**
+   * Return true(1) if the given sequence number may be written
+   * otherwise false(0).
+   * @param[in] seq sequence number.
+   * @return bool.
+   */
+  static bool is_valid(uint16_t seq)
+  {
+    return ((seq != 0) && (seq != 0xffff));
+  }
+
+  /**
+   * Return true(1) if sequence number a is newer than b (serial
+   * number arithmetic) otherwise false(0).
+   * @param[in] a sequence number.
+   * @param[in] b sequence number.
+   * @return bool.
+   */
+  static bool is_newer(uint16_t a, uint16_t b)
+  {
+    return ((int16_t) (a - b) > 0);
+  }
+
+  /**
+   * Calculate checksum (CRC-16/CCITT) of given sequence number and
+   * record buffer.
+   * @param[in] seq sequence number.
+   * @return checksum.
+   */
+  uint16_t crc(uint16_t seq)
+  {
+    uint16_t res = 0xffff;
+    res = crc_update(res, seq);
+    res = crc_update(res, seq >> 8);
+    const uint8_t* bp = (const uint8_t*) m_buf;
+    for (size_t i = 0; i < MSIZE; i++)
+      res = crc_update(res, *bp++);
+    return (res);
+  }
+
+  /**
+   * Update checksum (CRC-16/CCITT) with given data byte.
+   * @param[in] crc checksum.
+   * @param[in] data byte.
+   * @return checksum.
+   */
+  static uint16_t crc_update(uint16_t crc, uint8_t data)
+  {
+    data ^= crc & 0xff;
+    data ^= data << 4;
+    return ((((uint16_t) data << 8) | (crc >> 8))
+	    ^ (uint8_t) (data >> 4)
+	    ^ ((uint16_t) data << 3));
+  }
+};
+#endif
@@ -0,0 +1,533 @@
+/**
+ * @file Pager.h
+ * @version 1.0
+ *
+ * @section License
+ * Copyright (C) 2017, Mikael Patel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ */
+
+#ifndef PAGER_H
+#define PAGER_H
+
+#include "Storage.h"
+
+/**
+ * Software paging of a storage block with the given number of local
+ * memory page frames. The block is accessed by offset; pages are
+ * read to frames on access (page fault) and modified pages are
+ * written back on replacement (clock) or flush(). External pointers,
+ * ext_ptr<T>, allow data structures larger than local memory to be
+ * accessed with pointer syntax.
+ * @param[in] FRAME_MAX number of page frames.
+ */
+template<uint8_t FRAME_MAX>
+class Pager : public Storage::Block {
+public:
+  /**
+   * Construct pager on given storage device with the given frame
+   * buffer, page size and number of bytes. The size is rounded up to
+   * whole pages. The frame buffer must hold FRAME_MAX pages.
+   * @param[in] mem storage device.
+   * @param[in] frames frame buffer address.
+   * @param[in] page_max number of bytes per page.
+   * @param[in] size number of bytes.
+   */
+  Pager(Storage& mem, void* frames, uint16_t page_max, uint32_t size) :
+    Block(mem, ((size + page_max - 1) / page_max) * page_max),
+    PAGE_MAX(page_max),
+    m_frames((uint8_t*) frames),
+    m_hand(0),
+    m_top(0),
+    m_hits(0),
+    m_misses(0)
+  {
+    memset(m_flags, 0, sizeof(m_flags));
+  }
+
+  /**
+   * Write back modified pages and destruct pager.
+   */
+  ~Pager()
+  {
+    flush();
+  }
+
+  /** Number of bytes per page. */
+  const uint16_t PAGE_MAX;
+
+  /**
+   * Allocate given number of bytes in the paged block. Allocations
+   * not larger than a page do not cross a page boundary. Returns
+   * offset or UINT32_MAX if out of memory.
+   * @param[in] size number of bytes.
+   * @return offset.
+   */
+  uint32_t alloc(size_t size)
+  {
+    if ((size <= PAGE_MAX) && ((m_top % PAGE_MAX) + size > PAGE_MAX))
+      m_top += PAGE_MAX - (m_top % PAGE_MAX);
+    if (m_top + size > SIZE) return (UINT32_MAX);
+    uint32_t res = m_top;
+    m_top += size;
+    return (res);
+  }
+
+  /**
+   * Page in the page holding the given offset and return pointer to
+   * the offset in the frame, or NULL on error. The pointer is valid
+   * until the next pager access.
+   * @param[in] offset in block.
+   * @param[in] dirty mark page as modified.
+   * @return pointer or NULL.
+   */
+  uint8_t* fault(uint32_t offset, bool dirty)
+  {
+    if (offset >= SIZE) return (NULL);
+    int frame = page_in(offset / PAGE_MAX, true);
+    if (frame < 0) return (NULL);
+    if (dirty) m_flags[frame] |= DIRTY;
+    return (m_frames + (frame * PAGE_MAX) + (offset % PAGE_MAX));
+  }
+
+  /**
+   * Read given number of bytes from offset in block to buffer. Pages
+   * are read to frames when needed. Returns number of bytes read or
+   * negative error code.
+   * @param[in] dst buffer pointer.
+   * @param[in] offset in block.
+   * @param[in] count number of bytes.
+   * @return number of bytes read or negative error code.
+   */
+  int read(void* dst, uint32_t offset, size_t count)
+  {
+    if (offset + count > SIZE) return (-1);
+    uint8_t* p = (uint8_t*) dst;
+    size_t s = count;
+    while (s != 0) {
+      uint16_t pos = offset % PAGE_MAX;
+      size_t n = PAGE_MAX - pos;
+      if (n > s) n = s;
+      int frame = page_in(offset / PAGE_MAX, true);
+      if (frame < 0) return (-1);
+      memcpy(p, m_frames + (frame * PAGE_MAX) + pos, n);
+      offset += n;
+      p += n;
+      s -= n;
+    }
+    return (count);
+  }
+
+  /**
+   * Write given number of bytes from buffer to offset in block.
+   * Partially written pages are read to frames when needed; pages
+   * are written back on replacement or flush(). Returns number of
+   * bytes written or negative error code.
+   * @param[in] offset in block.
+   * @param[in] src buffer pointer.
+   * @param[in] count number of bytes.
+   * @return number of bytes written or negative error code.
+   */
+  int write(uint32_t offset, const void* src, size_t count)
+  {
+    if (offset + count > SIZE) return (-1);
+    const uint8_t* p = (const uint8_t*) src;
+    size_t s = count;
+    while (s != 0) {
+      uint16_t pos = offset % PAGE_MAX;
+      size_t n = PAGE_MAX - pos;
+      if (n > s) n = s;
+      int frame = page_in(offset / PAGE_MAX, n != PAGE_MAX);
+      if (frame < 0) return (-1);
+      memcpy(m_frames + (frame * PAGE_MAX) + pos, p, n);
+      m_flags[frame] |= DIRTY;
+      offset += n;
+      p += n;
+      s -= n;
+    }
+    return (count);
+  }
+
+  /**
+   * Write modified pages to storage. Returns number of pages written
+   * or negative error code.
+   * @return number of pages written or negative error code.
+   */
+  int flush()
+  {
+    int res = 0;
+    for (uint8_t frame = 0; frame < FRAME_MAX; frame++) {
+      if ((m_flags[frame] & DIRTY) == 0) continue;
+      if (writeback(frame) < 0) return (-1);
+      res += 1;
+    }
+    return (res);
+  }
+
+  /**
+   * Returns number of page accesses handled by the frames.
+   * @return number of hits.
+   */
+  uint32_t hits()
+  {
+    return (m_hits);
+  }
+
+  /**
+   * Returns number of page accesses that required a page fault.
+   * @return number of misses.
+   */
+  uint32_t misses()
+  {
+    return (m_misses);
+  }
+
+  /**
+   * External pointer to member(s) of given type in the paged
+   * block. Dereference pages in the member. Members should not cross
+   * page boundaries (see alloc()) when accessed with operator->().
+   * Access through a const pointer or get() does not mark the page
+   * as modified.
+   * @param[in] T member type.
+   */
+  template<typename T>
+  class ext_ptr {
+  public:
+    /**
+     * Member reference proxy; reads the member on conversion to the
+     * member type and writes the member on assignment.
+     */
+    class Reference {
+    public:
+      /**
+       * Construct reference to member at given offset in pager.
+       * @param[in] pager paged block.
+       * @param[in] offset in block.
+       */
+      Reference(Pager* pager, uint32_t offset) :
+	m_pager(pager),
+	m_offset(offset)
+      {
+      }
+
+      /**
+       * Read and return member value. The value is zero (value
+       * initialized) if the read fails.
+       * @return value.
+       */
+      operator T() const
+      {
+	T res = T();
+	m_pager->read(&res, m_offset, sizeof(T));
+	return (res);
+      }
+
+      /**
+       * Write given value to member.
+       * @param[in] value member value.
+       * @return reference.
+       */
+      Reference& operator=(const T& value)
+      {
+	m_pager->write(m_offset, &value, sizeof(T));
+	return (*this);
+      }
+
+      /**
+       * Copy member value from given reference.
+       * @param[in] other member reference.
+       * @return reference.
+       */
+      Reference& operator=(const Reference& other)
+      {
+	return (*this = (T) other);
+      }
+
+    protected:
+      /** Paged block. */
+      Pager* m_pager;
+
+      /** Member offset. */
+      const uint32_t m_offset;
+    };
+
+    /**
+     * Construct null pointer.
+     */
+    ext_ptr() :
+      m_pager(NULL),
+      m_offset(UINT32_MAX)
+    {
+    }
+
+    /**
+     * Construct pointer to member at given offset in pager.
+     * @param[in] pager paged block.
+     * @param[in] offset in block.
+     */
+    ext_ptr(Pager& pager, uint32_t offset) :
+      m_pager(&pager),
+      m_offset(offset)
+    {
+    }
+
+    /**
+     * Returns offset of member in paged block.
+     * @return offset.
+     */
+    uint32_t offset() const
+    {
+      return (m_offset);
+    }
+
+    /**
+     * Return true(1) if the pointer is not null otherwise false(0).
+     * @return bool.
+     */
+    operator bool() const
+    {
+      return (m_offset != UINT32_MAX);
+    }
+
+    /**
+     * Returns reference proxy for member.
+     * @return member reference.
+     */
+    Reference operator*() const
+    {
+      return (Reference(m_pager, m_offset));
+    }
+
+    /**
+     * Returns reference proxy for indexed member.
+     * @param[in] ix member index.
+     * @return member reference.
+     */
+    Reference operator[](size_t ix) const
+    {
+      return (Reference(m_pager, m_offset + (ix * sizeof(T))));
+    }
+
+    /**
+     * Page in member and return pointer to member in frame. The page
+     * is marked as modified. The pointer is valid until the next
+     * pager access.
+     * @return member pointer.
+     */
+    T* operator->()
+    {
+      return ((T*) m_pager->fault(m_offset, true));
+    }
+
+    /**
+     * Page in member and return read-only pointer to member in
+     * frame. The page is not marked as modified. The pointer is valid
+     * until the next pager access.
+     * @return member pointer.
+     */
+    const T* operator->() const
+    {
+      return (get());
+    }
+
+    /**
+     * Page in member and return read-only pointer to member in
+     * frame. The page is not marked as modified; use for read-only
+     * traversal. The pointer is valid until the next pager access.
+     * @return member pointer.
+     */
+    const T* get() const
+    {
+      return ((const T*) m_pager->fault(m_offset, false));
+    }
+
+    /**
+     * Step to next member.
+     * @return pointer.
+     */
+    ext_ptr& operator++()
+    {
+      m_offset += sizeof(T);
+      return (*this);
+    }
+
+    /**
+     * Step to previous member.
+     * @return pointer.
+     */
+    ext_ptr& operator--()
+    {
+      m_offset -= sizeof(T);
+      return (*this);
+    }
+
+    /**
+     * Returns pointer to member with given index.
+     * @param[in] ix member index.
+     * @return pointer.
+     */
+    ext_ptr operator+(int32_t ix) const
+    {
+      return (ext_ptr(*m_pager, m_offset + (ix * (int32_t) sizeof(T))));
+    }
+
+    /**
+     * Returns number of members between the pointers.
+     * @param[in] other pointer.
+     * @return number of members.
+     */
+    int32_t operator-(const ext_ptr& other) const
+    {
+      return (((int32_t) (m_offset - other.m_offset)) / (int32_t) sizeof(T));
+    }
+
+    /**
+     * Returns true(1) if the pointers are equal.
+     * @param[in] other pointer.
+     * @return bool.
+     */
+    bool operator==(const ext_ptr& other) const
+    {
+      return (m_offset == other.m_offset);
+    }
+
+    /**
+     * Returns true(1) if the pointers are not equal.
+     * @param[in] other pointer.
+     * @return bool.
+     */
+    bool operator!=(const ext_ptr& other) const
+    {
+      return (m_offset != other.m_offset);
+    }
+
+  protected:
+    /** Paged block. */
+    Pager* m_pager;
+
+    /** Member offset. */
+    uint32_t m_offset;
+  };
+
+  /**
+   * Allocate given number of members of given type in the paged
+   * block. Returns pointer to first member or null pointer if out of
+   * memory.
+   * @param[in] T member type.
+   * @param[in] nmemb number of members (default 1).
+   * @return pointer.
+   */
+  template<typename T>
+  ext_ptr<T> alloc(size_t nmemb = 1)
+  {
+    uint32_t offset = alloc(nmemb * sizeof(T));
+    if (offset == UINT32_MAX) return (ext_ptr<T>());
+    return (ext_ptr<T>(*this, offset));
+  }
+
+protected:
+  /** Frame state flags. */
+  enum {
+    VALID = 0x01,		//!< Frame holds page.
+    DIRTY = 0x02,		//!< Frame modified.
+    REFERENCED = 0x04		//!< Frame accessed since last sweep.
+  };
+
+  /** Frame buffer. */
+  uint8_t* m_frames;
+
+  /** Page index per frame. */
+  uint32_t m_page[FRAME_MAX];
+
+  /** State flags per frame. */
+  uint8_t m_flags[FRAME_MAX];
+
+  /** Clock hand for replacement. */
+  uint8_t m_hand;
+
+  /** Allocation offset. */
+  uint32_t m_top;
+
+  /** Number of frame hits. */
+  uint32_t m_hits;
+
+  /** Number of page faults. */
+  uint32_t m_misses;
+
+  /**
+   * Return frame holding the given page. On page fault a frame is
+   * replaced and the page is read if fill is true(1), otherwise the
+   * frame is only assigned (page will be written completely).
+   * Returns frame or negative error code.
+   * @param[in] page index.
+   * @param[in] fill read page on page fault.
+   * @return frame or negative error code.
+   */
+  int page_in(uint32_t page, bool fill)
+  {
+    for (uint8_t frame = 0; frame < FRAME_MAX; frame++) {
+      if ((m_flags[frame] & VALID) && (m_page[frame] == page)) {
+	m_flags[frame] |= REFERENCED;
+	m_hits += 1;
+	return (frame);
+      }
+    }
+    m_misses += 1;
+    int frame = replace();
+    if (frame < 0) return (-1);
+    if (fill && (m_mem.read(m_frames + (frame * PAGE_MAX),
+			    m_addr + (page * PAGE_MAX),
+			    PAGE_MAX) < 0))
+      return (-1);
+    m_page[frame] = page;
+    m_flags[frame] = VALID | REFERENCED;
+    return (frame);
+  }
+
+  /**
+   * Select frame for replacement with the clock (second chance)
+   * algorithm and write back if modified. Returns free frame or
+   * negative error code.
+   * @return frame or negative error code.
+   */
+  int replace()
+  {
+    while (1) {
+      uint8_t frame = m_hand;
+      if (++m_hand == FRAME_MAX) m_hand = 0;
+      if ((m_flags[frame] & VALID) == 0) return (frame);
+      if (m_flags[frame] & REFERENCED) {
+	m_flags[frame] &= ~REFERENCED;
+	continue;
+      }
+      if ((m_flags[frame] & DIRTY) && (writeback(frame) < 0)) return (-1);
+      m_flags[frame] = 0;
+      return (frame);
+    }
+  }
+
+  /**
+   * Write frame page to storage and mark as clean. Returns number of
+   * bytes written or negative error code.
+   * @param[in] frame index.
+   * @return number of bytes written or negative error code.
+   */
+  int writeback(uint8_t frame)
+  {
+    int res = m_mem.write(m_addr + (m_page[frame] * PAGE_MAX),
+			  m_frames + (frame * PAGE_MAX),
+			  PAGE_MAX);
+    if (res >= 0) m_flags[frame] &= ~DIRTY;
+    return (res);
+  }
+};
+#endif
@@ -19,10 +19,30 @@
 #ifndef STORAGE_H
 #define STORAGE_H
 
+/**
+ * Maximum number of free extents in the storage allocator table.
+ * Each extent requires 8 bytes of local memory per storage device.
+ * Default 4 (32 bytes). With zero, free only rewinds the allocation
+ * point when the block is the last allocated, other blocks are
+ * leaked.
+ */
+#ifndef STORAGE_FREE_MAX
+#define STORAGE_FREE_MAX 4
+#endif
+
+/**
+ * Maximum merge fan-in of the external sort (Cache::Sort). Each
+ * input requires four index variables on the stack during merge.
+ */
+#ifndef STORAGE_SORT_FANIN_MAX
+#define STORAGE_SORT_FANIN_MAX 16
+#endif
+
 /**
  * External memory storage interface, data block read/write, caching
- * and streaming class. Handles linear allocation of storage blocks on
- * the device.
+ * and streaming class. Handles allocation of storage blocks on the
+ * device; free extents below the allocation point may be kept in a
+ * local memory table (STORAGE_FREE_MAX, best fit, coalesced on free).
  */
 class Storage {
 public:
@@ -33,38 +53,178 @@ public:
    * Create storage manager with given number of bytes.
    * @param[in] size number of bytes on device.
    */
-  Storage(uint32_t size) : SIZE(size), m_addr(0) {}
+  Storage(uint32_t size) :
+    SIZE(size),
+    m_addr(0),
+    m_leaked(0)
+#if STORAGE_FREE_MAX > 0
+    , m_free(),
+    m_fragments(0)
+#endif
+  {}
 
   /**
-   * Returns number of bytes that may be allocated.
+   * Returns number of bytes that may be allocated; free extents and
+   * bytes after the allocation point.
    * @return number of bytes.
    */
   uint32_t room()
   {
-    return (SIZE - m_addr);
+    uint32_t res = SIZE - m_addr;
+#if STORAGE_FREE_MAX > 0
+    for (uint8_t i = 0; i < m_fragments; i++) res += m_free[i].size;
+#endif
+    return (res);
+  }
+
+  /**
+   * Returns number of bytes in largest block that may be allocated.
+   * @return number of bytes.
+   */
+  uint32_t largest()
+  {
+    uint32_t res = SIZE - m_addr;
+#if STORAGE_FREE_MAX > 0
+    for (uint8_t i = 0; i < m_fragments; i++)
+      if (m_free[i].size > res) res = m_free[i].size;
+#endif
+    return (res);
+  }
+
+  /**
+   * Returns number of free extents below the allocation point.
+   * @return number of extents.
+   */
+  uint8_t fragments()
+  {
+#if STORAGE_FREE_MAX > 0
+    return (m_fragments);
+#else
+    return (0);
+#endif
+  }
+
+  /**
+   * Returns number of bytes lost when the free extent table was
+   * full; the smallest extent is dropped. Without table, the number
+   * of bytes in blocks freed below the allocation point.
+   * @return number of bytes.
+   */
+  uint32_t leaked()
+  {
+    return (m_leaked);
   }
 
   /**
-   * Allocate block with given number of bytes on storage. Returns
-   * storage address if successful otherwise UINT32_MAX.
+   * Allocate block with given number of bytes on storage. The
+   * smallest free extent that fits is used, otherwise the block is
+   * allocated at the allocation point. Returns storage address if
+   * successful otherwise UINT32_MAX. Zero count returns the
+   * allocation point.
    * @param[in] count number of bytes.
    * @return address of allocated block, otherwise UINT32_MAX.
    */
   uint32_t alloc(size_t count)
   {
-    if (count > room()) return (UINT32_MAX);
-    uint32_t res = m_addr;
+    if (count == 0) return (m_addr);
+    uint32_t res;
+#if STORAGE_FREE_MAX > 0
+    int8_t best = -1;
+    for (uint8_t i = 0; i < m_fragments; i++) {
+      if (m_free[i].size < count) continue;
+      if ((best < 0) || (m_free[i].size < m_free[best].size)) best = i;
+      if (m_free[i].size == count) break;
+    }
+    if (best >= 0) {
+      res = m_free[best].addr;
+      m_free[best].addr += count;
+      m_free[best].size -= count;
+      if (m_free[best].size == 0) remove(best);
+      return (res);
+    }
+#endif
+    if (count > SIZE - m_addr) return (UINT32_MAX);
+    res = m_addr;
     m_addr += count;
     return (res);
   }
 
   /**
-   * Reset allocation point to given address.
+   * Free block with given address and number of bytes. The block is
+   * coalesced with adjacent free extents and the allocation point.
+   * Without free extent table only the last allocated block is
+   * returned to the allocation point.
+   * @param[in] addr address of allocated block.
+   * @param[in] count number of bytes.
+   */
+  void free(uint32_t addr, size_t count)
+  {
+    if ((addr == UINT32_MAX) || (count == 0) || (addr + count > m_addr))
+      return;
+#if STORAGE_FREE_MAX == 0
+    if (addr + count == m_addr)
+      m_addr = addr;
+    else
+      m_leaked += count;
+#else
+    uint8_t i = 0;
+    while ((i < m_fragments) && (m_free[i].addr < addr)) i++;
+    bool prev = (i > 0) && (m_free[i - 1].addr + m_free[i - 1].size == addr);
+    bool next = (i < m_fragments) && (addr + count == m_free[i].addr);
+    if (addr + count == m_addr) {
+      m_addr = addr;
+    }
+    else if (prev && next) {
+      m_free[i - 1].size += count + m_free[i].size;
+      remove(i);
+    }
+    else if (prev) {
+      m_free[i - 1].size += count;
+    }
+    else if (next) {
+      m_free[i].addr = addr;
+      m_free[i].size += count;
+    }
+    else {
+      if (m_fragments == STORAGE_FREE_MAX) {
+	uint8_t min = 0;
+	for (uint8_t j = 1; j < m_fragments; j++)
+	  if (m_free[j].size < m_free[min].size) min = j;
+	if (m_free[min].size >= count) {
+	  m_leaked += count;
+	  return;
+	}
+	m_leaked += m_free[min].size;
+	remove(min);
+	if (min < i) i -= 1;
+      }
+      for (uint8_t j = m_fragments; j > i; j--) m_free[j] = m_free[j - 1];
+      m_free[i].addr = addr;
+      m_free[i].size = count;
+      m_fragments += 1;
+    }
+    top();
+#endif
+  }
+
+  /**
+   * Reset allocation point to given address. All blocks allocated
+   * after the address are freed.
    * @param[in] addr address of allocated block.
    */
   void free(uint32_t addr)
   {
-    if (addr < m_addr) m_addr = addr;
+    if (addr >= m_addr) return;
+    m_addr = addr;
+#if STORAGE_FREE_MAX > 0
+    while ((m_fragments > 0) && (m_free[m_fragments - 1].addr >= addr))
+      m_fragments -= 1;
+    if (m_fragments > 0) {
+      extent_t& last = m_free[m_fragments - 1];
+      if (last.addr + last.size > addr) last.size = addr - last.addr;
+    }
+    top();
+#endif
   }
 
   /**
@@ -87,6 +247,98 @@ public:
    */
   virtual int write(uint32_t dest, const void* src, size_t count) = 0;
 
+  /**
+   * Storage segment; device address, buffer and number of bytes for
+   * scatter/gather read and write.
+   */
+  struct vec_t {
+    uint32_t addr;		//!< Memory address on device.
+    void* buf;			//!< Buffer pointer.
+    size_t size;		//!< Number of bytes.
+  };
+
+  /**
+   * Read given number of segments from storage to the segment
+   * buffers. Returns number of bytes read or negative error
+   * code. Default implementation reads one segment at a time; device
+   * drivers may override and merge adjacent segments.
+   * @param[in] vec segment vector.
+   * @param[in] count number of segments.
+   * @return number of bytes read or negative error code.
+   */
+  virtual int readv(const vec_t* vec, size_t count)
+  {
+    int res = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (read(vec[i].buf, vec[i].addr, vec[i].size) < 0) return (-1);
+      res += vec[i].size;
+    }
+    return (res);
+  }
+
+  /**
+   * Write given number of segments from the segment buffers to
+   * storage. Returns number of bytes written or negative error
+   * code. Default implementation writes one segment at a time; device
+   * drivers may override and merge adjacent segments.
+   * @param[in] vec segment vector.
+   * @param[in] count number of segments.
+   * @return number of bytes written or negative error code.
+   */
+  virtual int writev(const vec_t* vec, size_t count)
+  {
+    int res = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (write(vec[i].addr, vec[i].buf, vec[i].size) < 0) return (-1);
+      res += vec[i].size;
+    }
+    return (res);
+  }
+
+  /**
+   * Copy count number of bytes from source address on given storage
+   * device (or this device) to destination address on this device
+   * through the given bounce buffer. The bytes are moved in chunks of
+   * the buffer size aligned to the destination address (e.g. device
+   * page size). Overlapping regions on the same device are copied
+   * backwards when needed. Returns number of bytes copied or negative
+   * error code.
+   * @param[in] dest destination memory address on device.
+   * @param[in] mem source storage device.
+   * @param[in] src source memory address on source device.
+   * @param[in] count number of bytes to copy.
+   * @param[in] buf bounce buffer pointer.
+   * @param[in] size number of bytes in bounce buffer.
+   * @return number of bytes copied or negative error code.
+   */
+  int copy(uint32_t dest, Storage& mem, uint32_t src, size_t count,
+	   void* buf, size_t size)
+  {
+    if (size == 0) return (-1);
+    if ((&mem == this) && (dest == src)) return (count);
+    bool backward = (&mem == this) && (dest > src) && (dest < src + count);
+    size_t s = count;
+    while (s != 0) {
+      uint32_t offset;
+      size_t n;
+      if (backward) {
+	n = (dest + s) % size;
+	if (n == 0) n = size;
+	if (n > s) n = s;
+	offset = s - n;
+      }
+      else {
+	offset = count - s;
+	n = size - ((dest + offset) % size);
+	if (n > s) n = s;
+      }
+      if (mem.read(buf, src + offset, n) < 0) return (-1);
+      if (write(dest + offset, buf, n) < 0) return (-1);
+      s -= n;
+    }
+    return (count);
+  }
+
   /**
    * Allocated block of memory on storage.
    */
@@ -109,7 +361,7 @@ public:
      */
     ~Block()
     {
-      m_mem.free(m_addr);
+      m_mem.free(m_addr, SIZE);
     }
 
     /**
@@ -152,6 +404,21 @@ public:
       return (-1);
     }
 
+    /**
+     * Copy given block to this block through the given bounce
+     * buffer. The number of bytes copied is the size of the smaller
+     * block. Returns number of bytes copied or negative error code.
+     * @param[in] block source block.
+     * @param[in] buf bounce buffer pointer.
+     * @param[in] size number of bytes in bounce buffer.
+     * @return number of bytes copied or negative error code.
+     */
+    int copy(Block& block, void* buf, size_t size)
+    {
+      uint32_t count = (block.SIZE < SIZE ? block.SIZE : SIZE);
+      return (m_mem.copy(m_addr, block.m_mem, block.m_addr, count, buf, size));
+    }
+
     /** Size of memory block. */
     const uint32_t SIZE;
 
@@ -166,7 +433,10 @@ public:
   /**
    * Storage Cache for data; temporary or persistent external storage
    * of data with local memory copy. Allows element access of vectors
-   * on external storage.
+   * on external storage. Member read/write and invalidate are
+   * virtual so that the Iterator, Capture and Sort, which access the
+   * cache by reference, use the subclass (SlotCache, ShadowCache,
+   * ReadAheadCache) member access and local state.
    */
   class Cache : public Block {
   public:
@@ -188,6 +458,15 @@ public:
     {
     }
 
+    /**
+     * Invalidate local state derived from the storage block (none
+     * for Cache). Use when the storage block is modified by other
+     * means.
+     */
+    virtual void invalidate()
+    {
+    }
+
     /**
      * Returns storage address for the indexed storage block.
      * @param[in] ix member index (default 0):
@@ -209,7 +488,7 @@ public:
      * @param[in] ix member index (default 0):
      * @return number of bytes read or negative error code.
      */
-    int read(size_t ix = 0)
+    virtual int read(size_t ix = 0)
     {
       if (ix == 0)
 	return (m_mem.read(m_buf, m_addr, MSIZE));
@@ -225,7 +504,7 @@ public:
      * @param[in] ix member index (default 0):
      * @return number of bytes written or negative error code.
      */
-    int write(size_t ix = 0)
+    virtual int write(size_t ix = 0)
     {
       if (ix == 0)
 	return (m_mem.write(m_addr, m_buf, MSIZE));
@@ -234,6 +513,570 @@ public:
       return (-1);
     }
 
+    /**
+     * Read given number of consecutive members, starting with the
+     * indexed member, to the given buffer in a single storage
+     * transaction. Returns number of bytes read or negative error
+     * code.
+     * @param[in] buf buffer pointer (nmemb members).
+     * @param[in] ix index of first member.
+     * @param[in] nmemb number of members.
+     * @return number of bytes read or negative error code.
+     */
+    virtual int read(void* buf, size_t ix, size_t nmemb)
+    {
+      if (ix + nmemb <= NMEMB)
+	return (m_mem.read(buf, m_addr + (ix * MSIZE), nmemb * MSIZE));
+      return (-1);
+    }
+
+    /**
+     * Write given number of consecutive members, starting with the
+     * indexed member, from the given buffer in a single storage
+     * transaction. Returns number of bytes written or negative error
+     * code.
+     * @param[in] ix index of first member.
+     * @param[in] buf buffer pointer (nmemb members).
+     * @param[in] nmemb number of members.
+     * @return number of bytes written or negative error code.
+     */
+    virtual int write(size_t ix, const void* buf, size_t nmemb)
+    {
+      if (ix + nmemb <= NMEMB)
+	return (m_mem.write(m_addr + (ix * MSIZE), buf, nmemb * MSIZE));
+      return (-1);
+    }
+
+    /**
+     * Chunked member iterator. Members are read from storage a chunk
+     * at a time into the given chunk buffer and copied one by one to
+     * the cache buffer. A full scan costs a storage transaction per
+     * chunk instead of per member.
+     */
+    class Iterator {
+    public:
+      /**
+       * Construct iterator on given cache with the given chunk buffer
+       * and number of members per chunk, starting with the indexed
+       * member.
+       * @param[in] cache storage cache to iterate.
+       * @param[in] buf chunk buffer pointer (nmemb members).
+       * @param[in] nmemb number of members per chunk.
+       * @param[in] ix index of first member (default 0).
+       */
+      Iterator(Cache& cache, void* buf, size_t nmemb, size_t ix = 0) :
+	CHUNK_MAX(nmemb),
+	m_cache(cache),
+	m_buf((uint8_t*) buf),
+	m_ix(ix),
+	m_next(ix),
+	m_pos(0),
+	m_count(0)
+      {
+      }
+
+      /**
+       * Copy next member to the cache buffer, read next chunk from
+       * storage when needed. Returns true(1) if a member was
+       * available otherwise false(0).
+       * @return bool.
+       */
+      bool next()
+      {
+	if (m_pos == m_count) {
+	  if (m_next >= m_cache.NMEMB) return (false);
+	  size_t n = m_cache.NMEMB - m_next;
+	  if (n > CHUNK_MAX) n = CHUNK_MAX;
+	  if (m_cache.read(m_buf, m_next, n) < 0) return (false);
+	  m_count = n;
+	  m_pos = 0;
+	}
+	memcpy(m_cache.m_buf, m_buf + (m_pos * m_cache.MSIZE), m_cache.MSIZE);
+	m_pos += 1;
+	m_ix = m_next++;
+	return (true);
+      }
+
+      /**
+       * Returns index of the member in the cache buffer.
+       * @return member index.
+       */
+      size_t ix()
+      {
+	return (m_ix);
+      }
+
+      /** Number of members per chunk. */
+      const size_t CHUNK_MAX;
+
+    protected:
+      /** Storage cache. */
+      Cache& m_cache;
+
+      /** Chunk buffer. */
+      uint8_t* m_buf;
+
+      /** Index of current member. */
+      size_t m_ix;
+
+      /** Index of next member. */
+      size_t m_next;
+
+      /** Position of next member in chunk buffer. */
+      size_t m_pos;
+
+      /** Number of members in chunk buffer. */
+      size_t m_count;
+    };
+
+    /**
+     * Double-buffered (ping-pong) member capture. Members are put
+     * into one buffer while the other, full, buffer is written to
+     * storage with a single bulk transfer. Typically put() is called
+     * from an interrupt handler (e.g. timer sampling) and pump() from
+     * loop(). Members are dropped and counted as overflow when both
+     * buffers are full, or when the cache is full.
+     */
+    class Capture {
+    public:
+      /**
+       * Construct capture on given cache with the given buffer and
+       * buffer depth. The buffer must hold two times depth members.
+       * Members are written from the first member of the cache.
+       * @param[in] cache storage cache.
+       * @param[in] buf buffer pointer (2 * depth members).
+       * @param[in] depth number of members per buffer.
+       */
+      Capture(Cache& cache, void* buf, size_t depth) :
+	DEPTH(depth),
+	m_cache(cache),
+	m_buf((uint8_t*) buf),
+	m_fill(0),
+	m_len(0),
+	m_next(0),
+	m_ix(0),
+	m_overflows(0),
+	m_dropped(0)
+      {
+	m_full[0] = false;
+	m_full[1] = false;
+      }
+
+      /**
+       * Copy given member to the fill buffer. Returns true(1) if
+       * captured otherwise false(0) on overflow.
+       * @param[in] member pointer to member.
+       * @return bool.
+       */
+      bool put(const void* member)
+      {
+	if (m_full[m_fill]) {
+	  m_overflows += 1;
+	  return (false);
+	}
+	uint8_t* dst = m_buf + ((m_fill * DEPTH) + m_len) * m_cache.MSIZE;
+	memcpy(dst, member, m_cache.MSIZE);
+	m_len += 1;
+	if (m_len == DEPTH) {
+	  m_full[m_fill] = true;
+	  m_fill ^= 1;
+	  m_len = 0;
+	}
+	return (true);
+      }
+
+      /**
+       * Write full buffers to storage. Returns number of members
+       * written or negative error code.
+       * @return number of members or negative error code.
+       */
+      int pump()
+      {
+	int res = 0;
+	while (m_full[m_next]) {
+	  int n = write(m_buf + (m_next * DEPTH * m_cache.MSIZE), DEPTH);
+	  if (n < 0) return (n);
+	  res += n;
+	  m_full[m_next] = false;
+	  m_next ^= 1;
+	}
+	return (res);
+      }
+
+      /**
+       * Write full buffers and the members in the fill buffer to
+       * storage. Capture must be stopped (no put() during flush).
+       * Returns number of members written or negative error code.
+       * @return number of members or negative error code.
+       */
+      int flush()
+      {
+	int res = pump();
+	if ((res < 0) || (m_len == 0)) return (res);
+	int n = write(m_buf + (m_fill * DEPTH * m_cache.MSIZE), m_len);
+	if (n < 0) return (n);
+	m_fill ^= 1;
+	m_next = m_fill;
+	m_len = 0;
+	return (res + n);
+      }
+
+      /**
+       * Returns number of members written to storage.
+       * @return number of members.
+       */
+      size_t count()
+      {
+	return (m_ix);
+      }
+
+      /**
+       * Returns number of dropped members; buffer overflow or cache
+       * full. The overflow counter is updated by put() and read with
+       * interrupts disabled.
+       * @return number of members.
+       */
+      uint32_t overflows()
+      {
+	uint8_t sreg = SREG;
+	noInterrupts();
+	uint32_t res = m_overflows;
+	SREG = sreg;
+	return (res + m_dropped);
+      }
+
+      /**
+       * Return true(1) if the cache is full otherwise false(0).
+       * @return bool.
+       */
+      bool is_full()
+      {
+	return (m_ix == m_cache.NMEMB);
+      }
+
+      /** Number of members per buffer. */
+      const size_t DEPTH;
+
+    protected:
+      /** Storage cache. */
+      Cache& m_cache;
+
+      /** Buffers (2 * DEPTH members). */
+      uint8_t* m_buf;
+
+      /** Buffer full flags. */
+      volatile bool m_full[2];
+
+      /** Index of fill buffer. */
+      volatile uint8_t m_fill;
+
+      /** Number of members in fill buffer. */
+      volatile size_t m_len;
+
+      /** Index of next buffer to write. */
+      uint8_t m_next;
+
+      /** Index of next member in cache. */
+      size_t m_ix;
+
+      /** Number of members dropped on buffer overflow. */
+      volatile uint32_t m_overflows;
+
+      /** Number of members dropped on cache full. */
+      uint32_t m_dropped;
+
+      /**
+       * Write given number of members in buffer to the next members
+       * in the cache. Members beyond the end of the cache are
+       * dropped. Returns number of members written or negative error
+       * code.
+       * @param[in] buf buffer pointer.
+       * @param[in] nmemb number of members.
+       * @return number of members or negative error code.
+       */
+      int write(const uint8_t* buf, size_t nmemb)
+      {
+	size_t n = m_cache.NMEMB - m_ix;
+	if (n > nmemb) n = nmemb;
+	m_dropped += nmemb - n;
+	if ((n != 0) && (m_cache.write(m_ix, buf, n) < 0)) return (-1);
+	m_ix += n;
+	return (n);
+      }
+    };
+
+    /**
+     * External merge sort of the cache members with a local memory
+     * work buffer. Runs of members that fit the work buffer are read,
+     * sorted (qsort) and written back. The runs are merged k-way with
+     * a scratch block allocated on the same storage device. The
+     * fan-in is selected for the minimum number of merge passes with
+     * chunks of at least CHUNK_MIN bytes per transfer. The sort is
+     * not stable.
+     */
+    class Sort {
+    public:
+      /**
+       * Member compare function. Returns negative, zero or positive
+       * if member a is less, equal or greater than member b.
+       * @param[in] a member pointer.
+       * @param[in] b member pointer.
+       * @return compare result.
+       */
+      typedef int (*compare_t)(const void* a, const void* b);
+
+      /** Minimum number of bytes per merge chunk transfer. */
+      static const size_t CHUNK_MIN = 32;
+
+      /**
+       * Construct sort of given cache with the given work buffer,
+       * buffer size and member compare function. The buffer must
+       * hold at least three members.
+       * @param[in] cache storage cache to sort.
+       * @param[in] buf work buffer pointer.
+       * @param[in] size number of bytes in work buffer.
+       * @param[in] compare member compare function.
+       */
+      Sort(Cache& cache, void* buf, size_t size, compare_t compare) :
+	m_cache(cache),
+	m_buf((uint8_t*) buf),
+	m_size(size),
+	m_compare(compare),
+	m_passes(0),
+	m_bytes(0)
+      {
+      }
+
+      /**
+       * Sort cache members. Returns number of passes over the
+       * members (run sort, merge and copy back) or negative error
+       * code (work buffer too small, scratch allocation or storage
+       * failure).
+       * @return number of passes or negative error code.
+       */
+      int run()
+      {
+	int res = sort();
+	m_cache.invalidate();
+	return (res);
+      }
+
+      /**
+       * Returns number of passes of last run.
+       * @return number of passes.
+       */
+      uint8_t passes()
+      {
+	return (m_passes);
+      }
+
+      /**
+       * Returns number of bytes read and written by last run.
+       * @return number of bytes.
+       */
+      uint32_t bytes()
+      {
+	return (m_bytes);
+      }
+
+    protected:
+      /** Maximum merge fan-in. */
+      static const uint8_t FANIN_MAX = STORAGE_SORT_FANIN_MAX;
+
+      /** Storage cache. */
+      Cache& m_cache;
+
+      /** Work buffer. */
+      uint8_t* m_buf;
+
+      /** Number of bytes in work buffer. */
+      const size_t m_size;
+
+      /** Member compare function. */
+      compare_t m_compare;
+
+      /** Number of passes. */
+      uint8_t m_passes;
+
+      /** Number of bytes read and written. */
+      uint32_t m_bytes;
+
+      /**
+       * Sort runs and merge. Returns number of passes or negative
+       * error code. Run and merge lengths are 32-bit as the product of
+       * run length and fan-in may exceed the member index range.
+       * @return number of passes or negative error code.
+       */
+      int sort()
+      {
+	const size_t MSIZE = m_cache.MSIZE;
+	const size_t NMEMB = m_cache.NMEMB;
+	const size_t MEMB_MAX = m_size / MSIZE;
+	m_passes = 0;
+	m_bytes = 0;
+	if (MEMB_MAX < 3) return (-1);
+
+	// Sort runs that fit the work buffer
+	for (size_t ix = 0; ix < NMEMB; ix += MEMB_MAX) {
+	  size_t n = NMEMB - ix;
+	  if (n > MEMB_MAX) n = MEMB_MAX;
+	  if (m_cache.read(m_buf, ix, n) < 0) return (-1);
+	  qsort(m_buf, n, MSIZE, m_compare);
+	  if (m_cache.write(ix, m_buf, n) < 0) return (-1);
+	  m_bytes += 2 * n * MSIZE;
+	}
+	m_passes = 1;
+	if (NMEMB <= MEMB_MAX) return (m_passes);
+
+	// Select fan-in for minimum number of merge passes
+	size_t runs = (NMEMB + MEMB_MAX - 1) / MEMB_MAX;
+	size_t chunk = (CHUNK_MIN + MSIZE - 1) / MSIZE;
+	size_t kmax = MEMB_MAX / chunk;
+	if (kmax > FANIN_MAX + 1) kmax = FANIN_MAX + 1;
+	if (kmax < 3) kmax = 3;
+	kmax -= 1;
+	uint8_t k = 2;
+	while ((k < kmax) && (merges(runs, k) > merges(runs, kmax))) k++;
+	chunk = MEMB_MAX / (k + 1);
+
+	// Merge runs between the cache and scratch block
+	Block scratch(m_cache.m_mem, m_cache.SIZE);
+	if (scratch.addr() == UINT32_MAX) return (-1);
+	uint32_t src = m_cache.addr();
+	uint32_t dst = scratch.addr();
+	for (uint32_t len = MEMB_MAX; len < NMEMB; len *= k) {
+	  for (uint32_t ix = 0; ix < NMEMB; ix += len * k)
+	    if (merge(src, dst, ix, len, k, chunk) < 0) return (-1);
+	  uint32_t tmp = src;
+	  src = dst;
+	  dst = tmp;
+	  m_passes += 1;
+	}
+
+	// Copy back to cache if needed
+	if (src != m_cache.addr()) {
+	  if (m_cache.m_mem.copy(m_cache.addr(), m_cache.m_mem, src,
+				 m_cache.SIZE, m_buf, MEMB_MAX * MSIZE) < 0)
+	    return (-1);
+	  m_bytes += 2 * m_cache.SIZE;
+	  m_passes += 1;
+	}
+	return (m_passes);
+      }
+
+      /**
+       * Returns number of merge passes for given number of runs and
+       * fan-in.
+       * @param[in] runs number of runs.
+       * @param[in] k fan-in.
+       * @return number of passes.
+       */
+      static uint8_t merges(size_t runs, size_t k)
+      {
+	uint8_t res = 0;
+	while (runs > 1) {
+	  runs = (runs + k - 1) / k;
+	  res += 1;
+	}
+	return (res);
+      }
+
+      /**
+       * Merge k runs of given length, starting with the indexed
+       * member, from source to destination address. The work buffer
+       * holds a chunk per run and an output chunk. Returns zero or
+       * negative error code.
+       * @param[in] src source address.
+       * @param[in] dst destination address.
+       * @param[in] ix index of first member.
+       * @param[in] len number of members per run.
+       * @param[in] k number of runs.
+       * @param[in] chunk number of members per chunk.
+       * @return zero or negative error code.
+       */
+      int merge(uint32_t src, uint32_t dst,
+		uint32_t ix, uint32_t len, uint8_t k, size_t chunk)
+      {
+	const size_t MSIZE = m_cache.MSIZE;
+	const uint32_t NMEMB = m_cache.NMEMB;
+	Storage& mem = m_cache.m_mem;
+	uint32_t pos[FANIN_MAX];
+	uint32_t end[FANIN_MAX];
+	size_t head[FANIN_MAX];
+	size_t count[FANIN_MAX];
+	for (uint8_t i = 0; i < k; i++) {
+	  pos[i] = ix + i * len;
+	  if (pos[i] > NMEMB) pos[i] = NMEMB;
+	  end[i] = pos[i] + len;
+	  if (end[i] > NMEMB) end[i] = NMEMB;
+	  if (fill(src, i, pos[i], end[i], head[i], count[i], chunk) < 0)
+	    return (-1);
+	}
+	uint8_t* out = m_buf + (k * chunk * MSIZE);
+	size_t n = 0;
+	while (1) {
+	  int8_t sel = -1;
+	  const uint8_t* min = NULL;
+	  for (uint8_t i = 0; i < k; i++) {
+	    if (head[i] == count[i]) continue;
+	    const uint8_t* mp = m_buf + ((i * chunk) + head[i]) * MSIZE;
+	    if ((sel < 0) || (m_compare(mp, min) < 0)) {
+	      sel = i;
+	      min = mp;
+	    }
+	  }
+	  if (sel < 0) break;
+	  memcpy(out + (n * MSIZE), min, MSIZE);
+	  n += 1;
+	  head[sel] += 1;
+	  if ((head[sel] == count[sel])
+	      && (fill(src, sel, pos[sel], end[sel],
+		       head[sel], count[sel], chunk) < 0))
+	    return (-1);
+	  if (n == chunk) {
+	    if (mem.write(dst + (ix * MSIZE), out, n * MSIZE) < 0) return (-1);
+	    m_bytes += n * MSIZE;
+	    ix += n;
+	    n = 0;
+	  }
+	}
+	if (n == 0) return (0);
+	if (mem.write(dst + (ix * MSIZE), out, n * MSIZE) < 0) return (-1);
+	m_bytes += n * MSIZE;
+	return (0);
+      }
+
+      /**
+       * Read next chunk of run to the run chunk buffer. Returns zero
+       * or negative error code.
+       * @param[in] src source address.
+       * @param[in] i run index.
+       * @param[in,out] pos index of next member in run.
+       * @param[in] end index after last member in run.
+       * @param[out] head index of next member in chunk buffer.
+       * @param[out] count number of members in chunk buffer.
+       * @param[in] chunk number of members per chunk.
+       * @return zero or negative error code.
+       */
+      int fill(uint32_t src, uint8_t i, uint32_t& pos, uint32_t end,
+	       size_t& head, size_t& count, size_t chunk)
+      {
+	const size_t MSIZE = m_cache.MSIZE;
+	uint32_t n = end - pos;
+	if (n > chunk) n = chunk;
+	head = 0;
+	count = n;
+	if (n == 0) return (0);
+	if (m_cache.m_mem.read(m_buf + (i * chunk * MSIZE),
+			       src + (pos * MSIZE),
+			       n * MSIZE) < 0)
+	  return (-1);
+	m_bytes += n * MSIZE;
+	pos += n;
+	return (0);
+      }
+    };
+
     /** Size of member. */
     const size_t MSIZE;
 
@@ -246,79 +1089,1057 @@ public:
   };
 
   /**
-   * Stream of given size on given storage. Write/print intermediate
-   * data to the stream that may later be read and transfered.
-   * Multiple stream may be created on the same device.
+   * Storage Block on the given device driver type. Device access is
+   * with non-virtual (qualified) calls so that the driver read and
+   * write may be inlined and constant folded in the caller.
+   * @param[in] DEVICE storage device driver class.
    */
-  class Stream : public ::Stream {
+  template<class DEVICE>
+  class BlockOf : public Block {
   public:
     /**
-     * Construct stream on given storage device with the given size.
-     * @param[in] mem storage device for stream.
-     * @param[in] size number of bytes in stream.
+     * Construct block with given size on given storage device.
+     * @param[in] dev storage device for block.
+     * @param[in] size number of bytes.
      */
-    Stream(Storage &mem, size_t size) :
-      SIZE(size),
-      m_mem(mem),
-      m_addr(m_mem.alloc(size)),
-      m_put(0),
-      m_get(0),
-      m_count(0)
-    {
-    }
+    BlockOf(DEVICE &dev, uint32_t size) : Block(dev, size) {}
 
     /**
-     * Returns storage address for stream.
-     * @return address.
+     * Read given number of bytes from offset within block to given
+     * buffer. Returns number of bytes read or negative error code.
+     * @param[in] buf buffer pointer.
+     * @param[in] offset offset within block.
+     * @param[in] size number of bytes to read.
+     * @return number of bytes read or negative error code.
      */
-    uint32_t addr()
+    int read(void* buf, uint32_t offset, size_t size)
     {
-      return (m_addr);
+      if (offset + size <= SIZE)
+	return (dev().DEVICE::read(buf, m_addr + offset, size));
+      return (-1);
     }
 
     /**
-     * @override{Stream}
-     * Write given byte to stream. Return number of bytes written,
-     * zero if full.
-     * @param[in] byte to write.
-     * @return number of bytes written(1).
+     * Write given number of bytes from buffer to given offset
+     * within block. Returns number of bytes written or negative error
+     * code.
+     * @param[in] buf buffer pointer.
+     * @param[in] offset offset within block.
+     * @param[in] size number of bytes to write.
+     * @return number of bytes written or negative error code.
      */
-    virtual size_t write(uint8_t byte)
+    int write(uint32_t offset, const void* buf, size_t size)
     {
-      if (m_count == SIZE) return (0);
-      m_mem.write(m_addr + m_put, &byte, sizeof(byte));
-      m_count += 1;
-      m_put += 1;
-      if (m_put == SIZE) m_put = 0;
-      return (sizeof(byte));
+      if (offset + size <= SIZE)
+	return (dev().DEVICE::write(m_addr + offset, buf, size));
+      return (-1);
     }
 
+  protected:
     /**
-     * @override{Stream}
-     * Write given buffer and number of bytes to stream. Return number
-     * of bytes written, or zero if stream is full.
-     * @param[in] buffer to write.
-     * @param[in] size number of byets to write.
-     * @return number of bytes.
+     * Returns storage device as driver type.
+     * @return device driver.
      */
-    virtual size_t write(const uint8_t *buffer, size_t size)
+    DEVICE& dev()
     {
-      uint16_t room = SIZE - m_count;
-      if (room == 0) return (0);
-      if (size > room) size = room;
-      size_t res = size;
-      room = SIZE - m_put;
-      if (size > room) {
-	m_mem.write(m_addr + m_put, buffer, room);
-	buffer += room;
-	size -= room;
-	m_count += room;
-	m_put = 0;
-      }
-      m_mem.write(m_addr + m_put, buffer, size);
-      m_count += size;
-      m_put += size;
-      return (res);
+      return (static_cast<DEVICE&>(m_mem));
+    }
+  };
+
+  /**
+   * Storage Cache on the given device driver type. Device access is
+   * with non-virtual (qualified) calls so that the driver read and
+   * write may be inlined and constant folded in the caller. Member
+   * access is final; calls through a CacheOf are not dispatched.
+   * @param[in] DEVICE storage device driver class.
+   */
+  template<class DEVICE>
+  class CacheOf : public Cache {
+  public:
+    /**
+     * Construct cached block on given storage device with the given
+     * local buffer, member size and number of members.
+     * @param[in] dev storage device for block.
+     * @param[in] buf buffer address.
+     * @param[in] size number of bytes per member.
+     * @param[in] nmemb number of members (default 1).
+     */
+    CacheOf(DEVICE &dev, void* buf, size_t size, size_t nmemb = 1) :
+      Cache(dev, buf, size, nmemb)
+    {
+    }
+
+    /**
+     * Read indexed storage block to buffer. Default index is the
+     * first member. Returns number of bytes read or negative error
+     * code.
+     * @param[in] ix member index (default 0):
+     * @return number of bytes read or negative error code.
+     */
+    int read(size_t ix = 0) final
+    {
+      if (ix < NMEMB)
+	return (dev().DEVICE::read(m_buf, m_addr + (ix * MSIZE), MSIZE));
+      return (-1);
+    }
+
+    /**
+     * Write buffer to indexed storage block. Default index is the
+     * first member. Returns number of bytes written or negative error
+     * code.
+     * @param[in] ix member index (default 0):
+     * @return number of bytes written or negative error code.
+     */
+    int write(size_t ix = 0) final
+    {
+      if (ix < NMEMB)
+	return (dev().DEVICE::write(m_addr + (ix * MSIZE), m_buf, MSIZE));
+      return (-1);
+    }
+
+    /**
+     * Read given number of consecutive members, starting with the
+     * indexed member, to the given buffer in a single storage
+     * transaction. Returns number of bytes read or negative error
+     * code.
+     * @param[in] buf buffer pointer (nmemb members).
+     * @param[in] ix index of first member.
+     * @param[in] nmemb number of members.
+     * @return number of bytes read or negative error code.
+     */
+    int read(void* buf, size_t ix, size_t nmemb) final
+    {
+      if (ix + nmemb <= NMEMB)
+	return (dev().DEVICE::read(buf, m_addr + (ix * MSIZE), nmemb * MSIZE));
+      return (-1);
+    }
+
+    /**
+     * Write given number of consecutive members, starting with the
+     * indexed member, from the given buffer in a single storage
+     * transaction. Returns number of bytes written or negative error
+     * code.
+     * @param[in] ix index of first member.
+     * @param[in] buf buffer pointer (nmemb members).
+     * @param[in] nmemb number of members.
+     * @return number of bytes written or negative error code.
+     */
+    int write(size_t ix, const void* buf, size_t nmemb) final
+    {
+      if (ix + nmemb <= NMEMB)
+	return (dev().DEVICE::write(m_addr + (ix * MSIZE), buf, nmemb * MSIZE));
+      return (-1);
+    }
+
+  protected:
+    /**
+     * Returns storage device as driver type.
+     * @return device driver.
+     */
+    DEVICE& dev()
+    {
+      return (static_cast<DEVICE&>(m_mem));
+    }
+  };
+
+  /**
+   * Typed vector of given member type and number of members on
+   * storage. Members are accessed by value; read/write or element
+   * reference proxy with index operator, and forward iterator. The
+   * member size is a compile-time constant so that indexing
+   * compiles to a shift when it is a power of two.
+   * @param[in] T member type.
+   * @param[in] N number of members.
+   */
+  template<typename T, size_t N>
+  class Vector : public Block {
+  public:
+    /** Size of member. */
+    static constexpr size_t MSIZE = sizeof(T);
+
+    /** Number of members. */
+    static constexpr size_t NMEMB = N;
+
+    /**
+     * Construct vector on given storage device. Storage is allocated
+     * for the members.
+     * @param[in] mem storage device for vector.
+     */
+    Vector(Storage &mem) : Block(mem, N * sizeof(T)) {}
+
+    /**
+     * Returns storage address for the indexed member.
+     * @param[in] ix member index.
+     * @return address.
+     */
+    uint32_t addr(size_t ix = 0)
+    {
+      return (m_addr + (ix * sizeof(T)));
+    }
+
+    /**
+     * Read indexed member to given variable. Returns number of bytes
+     * read or negative error code.
+     * @param[in] ix member index.
+     * @param[out] value member value.
+     * @return number of bytes read or negative error code.
+     */
+    int read(size_t ix, T& value)
+    {
+      if (ix < N) return (m_mem.read(&value, addr(ix), sizeof(T)));
+      return (-1);
+    }
+
+    /**
+     * Write indexed member with given value. Returns number of bytes
+     * written or negative error code.
+     * @param[in] ix member index.
+     * @param[in] value member value.
+     * @return number of bytes written or negative error code.
+     */
+    int write(size_t ix, const T& value)
+    {
+      if (ix < N) return (m_mem.write(addr(ix), &value, sizeof(T)));
+      return (-1);
+    }
+
+    /**
+     * Read given number of consecutive members, starting with the
+     * indexed member, to the given buffer in a single storage
+     * transaction. Returns number of bytes read or negative error
+     * code.
+     * @param[in] buf member buffer.
+     * @param[in] ix index of first member.
+     * @param[in] nmemb number of members.
+     * @return number of bytes read or negative error code.
+     */
+    int read(T* buf, size_t ix, size_t nmemb)
+    {
+      if (ix + nmemb <= N)
+	return (m_mem.read(buf, addr(ix), nmemb * sizeof(T)));
+      return (-1);
+    }
+
+    /**
+     * Write given number of consecutive members, starting with the
+     * indexed member, from the given buffer in a single storage
+     * transaction. Returns number of bytes written or negative error
+     * code.
+     * @param[in] ix index of first member.
+     * @param[in] buf member buffer.
+     * @param[in] nmemb number of members.
+     * @return number of bytes written or negative error code.
+     */
+    int write(size_t ix, const T* buf, size_t nmemb)
+    {
+      if (ix + nmemb <= N)
+	return (m_mem.write(addr(ix), buf, nmemb * sizeof(T)));
+      return (-1);
+    }
+
+    /**
+     * Member reference proxy; reads the member on conversion to the
+     * member type and writes the member on assignment.
+     */
+    class Reference {
+    public:
+      /**
+       * Construct reference to indexed member in given vector.
+       * @param[in] vec vector.
+       * @param[in] ix member index.
+       */
+      Reference(Vector& vec, size_t ix) : m_vec(vec), m_ix(ix) {}
+
+      /**
+       * Read and return member value. The value is zero (value
+       * initialized) if the read fails.
+       * @return value.
+       */
+      operator T() const
+      {
+	T res = T();
+	m_vec.read(m_ix, res);
+	return (res);
+      }
+
+      /**
+       * Write given value to member.
+       * @param[in] value member value.
+       * @return reference.
+       */
+      Reference& operator=(const T& value)
+      {
+	m_vec.write(m_ix, value);
+	return (*this);
+      }
+
+      /**
+       * Copy member value from given reference.
+       * @param[in] other member reference.
+       * @return reference.
+       */
+      Reference& operator=(const Reference& other)
+      {
+	return (*this = (T) other);
+      }
+
+    protected:
+      /** Vector of member. */
+      Vector& m_vec;
+
+      /** Member index. */
+      const size_t m_ix;
+    };
+
+    /**
+     * Forward iterator; reads the member on dereference.
+     */
+    class Iterator {
+    public:
+      /**
+       * Construct iterator for given vector and member index.
+       * @param[in] vec vector.
+       * @param[in] ix member index.
+       */
+      Iterator(Vector& vec, size_t ix) : m_vec(vec), m_ix(ix) {}
+
+      /**
+       * Read and return member value. The value is zero (value
+       * initialized) if the read fails.
+       * @return value.
+       */
+      T operator*() const
+      {
+	T res = T();
+	m_vec.read(m_ix, res);
+	return (res);
+      }
+
+      /**
+       * Step to next member.
+       * @return iterator.
+       */
+      Iterator& operator++()
+      {
+	m_ix += 1;
+	return (*this);
+      }
+
+      /**
+       * Returns true(1) if the iterators are at different members.
+       * @param[in] other iterator.
+       * @return bool.
+       */
+      bool operator!=(const Iterator& other) const
+      {
+	return (m_ix != other.m_ix);
+      }
+
+      /**
+       * Returns true(1) if the iterators are at the same member.
+       * @param[in] other iterator.
+       * @return bool.
+       */
+      bool operator==(const Iterator& other) const
+      {
+	return (m_ix == other.m_ix);
+      }
+
+    protected:
+      /** Vector of member. */
+      Vector& m_vec;
+
+      /** Member index. */
+      size_t m_ix;
+    };
+
+    /**
+     * Returns reference proxy for indexed member. The index is not
+     * checked; out of bound access is ignored on write.
+     * @param[in] ix member index.
+     * @return member reference.
+     */
+    Reference operator[](size_t ix)
+    {
+      return (Reference(*this, ix));
+    }
+
+    /**
+     * Returns iterator at first member.
+     * @return iterator.
+     */
+    Iterator begin()
+    {
+      return (Iterator(*this, 0));
+    }
+
+    /**
+     * Returns iterator after last member.
+     * @return iterator.
+     */
+    Iterator end()
+    {
+      return (Iterator(*this, N));
+    }
+  };
+
+  /**
+   * Storage Cache with given number of local memory slots for
+   * members. Members are read to and written from the slots and
+   * written back to storage on replacement (clock) or flush().
+   * Repeated access to members in the slots is handled without
+   * storage device transactions. Range reads include modified
+   * members in the slots and range writes replace them.
+   * @param[in] SLOT_MAX number of member slots.
+   */
+  template<uint8_t SLOT_MAX>
+  class SlotCache : public Cache {
+  public:
+    /**
+     * Construct slot cached block on given storage device with the
+     * given local buffer, slot buffer, member size and number of
+     * members. The slot buffer must hold SLOT_MAX members.
+     * @param[in] mem storage device for block.
+     * @param[in] buf buffer address.
+     * @param[in] slots slot buffer address.
+     * @param[in] size number of bytes per member.
+     * @param[in] nmemb number of members (default 1).
+     */
+    SlotCache(Storage &mem, void* buf, void* slots,
+	      size_t size, size_t nmemb = 1) :
+      Cache(mem, buf, size, nmemb),
+      m_slots((uint8_t*) slots),
+      m_hand(0),
+      m_hits(0),
+      m_misses(0)
+    {
+      memset(m_flags, 0, sizeof(m_flags));
+    }
+
+    /**
+     * Write back modified members and destruct slot cache.
+     */
+    ~SlotCache()
+    {
+      flush();
+    }
+
+    /**
+     * Read indexed member to buffer. The member is read from the
+     * slots if available otherwise from storage. Returns number of
+     * bytes read or negative error code.
+     * @param[in] ix member index (default 0):
+     * @return number of bytes read or negative error code.
+     */
+    int read(size_t ix = 0) final
+    {
+      if (ix >= NMEMB) return (-1);
+      int slot = lookup(ix);
+      if (slot < 0) {
+	slot = replace();
+	if (slot < 0) return (-1);
+	if (m_mem.read(m_slots + slot * MSIZE, m_addr + ix * MSIZE, MSIZE) < 0)
+	  return (-1);
+	m_ix[slot] = ix;
+	m_flags[slot] = VALID;
+      }
+      m_flags[slot] |= REFERENCED;
+      memcpy(m_buf, m_slots + slot * MSIZE, MSIZE);
+      return (MSIZE);
+    }
+
+    /**
+     * Write buffer to indexed member slot. The member is written to
+     * storage on replacement or flush(). Returns number of bytes
+     * written or negative error code.
+     * @param[in] ix member index (default 0):
+     * @return number of bytes written or negative error code.
+     */
+    int write(size_t ix = 0) final
+    {
+      if (ix >= NMEMB) return (-1);
+      int slot = lookup(ix);
+      if (slot < 0) {
+	slot = replace();
+	if (slot < 0) return (-1);
+	m_ix[slot] = ix;
+      }
+      m_flags[slot] = VALID | DIRTY | REFERENCED;
+      memcpy(m_slots + slot * MSIZE, m_buf, MSIZE);
+      return (MSIZE);
+    }
+
+    /**
+     * Read given number of consecutive members, starting with the
+     * indexed member, to the given buffer in a single storage
+     * transaction. Modified members in the slots are copied over the
+     * storage image. Returns number of bytes read or negative error
+     * code.
+     * @param[in] buf buffer pointer (nmemb members).
+     * @param[in] ix index of first member.
+     * @param[in] nmemb number of members.
+     * @return number of bytes read or negative error code.
+     */
+    int read(void* buf, size_t ix, size_t nmemb) final
+    {
+      int res = Cache::read(buf, ix, nmemb);
+      if (res < 0) return (res);
+      for (uint8_t slot = 0; slot < SLOT_MAX; slot++) {
+	if (((m_flags[slot] & DIRTY) == 0)
+	    || (m_ix[slot] < ix)
+	    || (m_ix[slot] >= ix + nmemb))
+	  continue;
+	memcpy((uint8_t*) buf + (m_ix[slot] - ix) * MSIZE,
+	       m_slots + slot * MSIZE,
+	       MSIZE);
+      }
+      return (res);
+    }
+
+    /**
+     * Write given number of consecutive members, starting with the
+     * indexed member, from the given buffer in a single storage
+     * transaction. Slots holding members in the range are dropped.
+     * Returns number of bytes written or negative error code.
+     * @param[in] ix index of first member.
+     * @param[in] buf buffer pointer (nmemb members).
+     * @param[in] nmemb number of members.
+     * @return number of bytes written or negative error code.
+     */
+    int write(size_t ix, const void* buf, size_t nmemb) final
+    {
+      int res = Cache::write(ix, buf, nmemb);
+      if (res < 0) return (res);
+      for (uint8_t slot = 0; slot < SLOT_MAX; slot++) {
+	if ((m_flags[slot] & VALID)
+	    && (m_ix[slot] >= ix)
+	    && (m_ix[slot] < ix + nmemb))
+	  m_flags[slot] = 0;
+      }
+      return (res);
+    }
+
+    /**
+     * Drop all slots without write back. Use when the storage block
+     * is modified by other means.
+     */
+    void invalidate() final
+    {
+      memset(m_flags, 0, sizeof(m_flags));
+    }
+
+    /**
+     * Write modified members in slots to storage. Returns number of
+     * members written or negative error code.
+     * @return number of members written or negative error code.
+     */
+    int flush()
+    {
+      int res = 0;
+      for (uint8_t slot = 0; slot < SLOT_MAX; slot++) {
+	if ((m_flags[slot] & DIRTY) == 0) continue;
+	if (writeback(slot) < 0) return (-1);
+	res += 1;
+      }
+      return (res);
+    }
+
+    /**
+     * Returns number of member accesses handled by the slots.
+     * @return number of hits.
+     */
+    uint32_t hits()
+    {
+      return (m_hits);
+    }
+
+    /**
+     * Returns number of member accesses that required a slot
+     * replacement.
+     * @return number of misses.
+     */
+    uint32_t misses()
+    {
+      return (m_misses);
+    }
+
+  protected:
+    /** Slot state flags. */
+    enum {
+      VALID = 0x01,		//!< Slot holds member.
+      DIRTY = 0x02,		//!< Slot modified.
+      REFERENCED = 0x04		//!< Slot accessed since last sweep.
+    };
+
+    /** Slot buffer. */
+    uint8_t* m_slots;
+
+    /** Member index per slot. */
+    size_t m_ix[SLOT_MAX];
+
+    /** State flags per slot. */
+    uint8_t m_flags[SLOT_MAX];
+
+    /** Clock hand for replacement. */
+    uint8_t m_hand;
+
+    /** Number of slot hits. */
+    uint32_t m_hits;
+
+    /** Number of slot misses. */
+    uint32_t m_misses;
+
+    /**
+     * Return slot holding indexed member otherwise negative error
+     * code(-1).
+     * @param[in] ix member index.
+     * @return slot or negative error code.
+     */
+    int lookup(size_t ix)
+    {
+      for (uint8_t slot = 0; slot < SLOT_MAX; slot++) {
+	if ((m_flags[slot] & VALID) && (m_ix[slot] == ix)) {
+	  m_hits += 1;
+	  return (slot);
+	}
+      }
+      m_misses += 1;
+      return (-1);
+    }
+
+    /**
+     * Select slot for replacement with the clock (second chance)
+     * algorithm and write back if modified. Returns free slot or
+     * negative error code.
+     * @return slot or negative error code.
+     */
+    int replace()
+    {
+      while (1) {
+	uint8_t slot = m_hand;
+	if (++m_hand == SLOT_MAX) m_hand = 0;
+	if ((m_flags[slot] & VALID) == 0) return (slot);
+	if (m_flags[slot] & REFERENCED) {
+	  m_flags[slot] &= ~REFERENCED;
+	  continue;
+	}
+	if ((m_flags[slot] & DIRTY) && (writeback(slot) < 0)) return (-1);
+	m_flags[slot] = 0;
+	return (slot);
+      }
+    }
+
+    /**
+     * Write slot member to storage and mark as clean. Returns number
+     * of bytes written or negative error code.
+     * @param[in] slot index.
+     * @return number of bytes written or negative error code.
+     */
+    int writeback(uint8_t slot)
+    {
+      int res = m_mem.write(m_addr + m_ix[slot] * MSIZE,
+			    m_slots + slot * MSIZE,
+			    MSIZE);
+      if (res >= 0) m_flags[slot] &= ~DIRTY;
+      return (res);
+    }
+  };
+
+  /**
+   * Storage Cache with a local memory shadow of the member image last
+   * read from or written to storage. Write of the shadowed member
+   * only transfers the span of modified bytes, or nothing if the
+   * member is unchanged. The modified bytes are written as a single
+   * span so that a page device (e.g. AT24CXX) requires at most one
+   * write cycle per page.
+   */
+  class ShadowCache : public Cache {
+  public:
+    /**
+     * Construct shadowed cache block on given storage device with
+     * the given local buffer, shadow buffer, member size and number
+     * of members. The shadow buffer must hold a member.
+     * @param[in] mem storage device for block.
+     * @param[in] buf buffer address.
+     * @param[in] shadow shadow buffer address.
+     * @param[in] size number of bytes per member.
+     * @param[in] nmemb number of members (default 1).
+     */
+    ShadowCache(Storage &mem, void* buf, void* shadow,
+		size_t size, size_t nmemb = 1) :
+      Cache(mem, buf, size, nmemb),
+      m_shadow((uint8_t*) shadow),
+      m_ix(nmemb),
+      m_skipped(0)
+    {
+    }
+
+    using Cache::read;
+
+    /**
+     * Read indexed storage block to buffer and shadow. Returns number
+     * of bytes read or negative error code.
+     * @param[in] ix member index (default 0):
+     * @return number of bytes read or negative error code.
+     */
+    int read(size_t ix = 0) final
+    {
+      int res = Cache::read(ix);
+      if (res < 0) {
+	m_ix = NMEMB;
+	return (res);
+      }
+      memcpy(m_shadow, m_buf, MSIZE);
+      m_ix = ix;
+      return (res);
+    }
+
+    /**
+     * Write buffer to indexed storage block. If the member is
+     * shadowed only the span of modified bytes is written. Returns
+     * number of bytes in member or negative error code.
+     * @param[in] ix member index (default 0):
+     * @return number of bytes or negative error code.
+     */
+    int write(size_t ix = 0) final
+    {
+      if (ix >= NMEMB) return (-1);
+      if (ix != m_ix) {
+	int res = Cache::write(ix);
+	if (res < 0) {
+	  m_ix = NMEMB;
+	  return (res);
+	}
+	memcpy(m_shadow, m_buf, MSIZE);
+	m_ix = ix;
+	return (res);
+      }
+      const uint8_t* bp = (const uint8_t*) m_buf;
+      size_t first = 0;
+      while ((first < MSIZE) && (bp[first] == m_shadow[first])) first++;
+      if (first == MSIZE) {
+	m_skipped += MSIZE;
+	return (MSIZE);
+      }
+      size_t last = MSIZE - 1;
+      while (bp[last] == m_shadow[last]) last--;
+      size_t n = last - first + 1;
+      if (m_mem.write(addr(ix) + first, bp + first, n) < 0) {
+	m_ix = NMEMB;
+	return (-1);
+      }
+      memcpy(m_shadow + first, bp + first, n);
+      m_skipped += MSIZE - n;
+      return (MSIZE);
+    }
+
+    /**
+     * Write given number of consecutive members, starting with the
+     * indexed member, from the given buffer in a single storage
+     * transaction. The shadow is invalidated if the shadowed member
+     * is written. Returns number of bytes written or negative error
+     * code.
+     * @param[in] ix index of first member.
+     * @param[in] buf buffer pointer (nmemb members).
+     * @param[in] nmemb number of members.
+     * @return number of bytes written or negative error code.
+     */
+    int write(size_t ix, const void* buf, size_t nmemb) final
+    {
+      if ((m_ix >= ix) && (m_ix < ix + nmemb)) m_ix = NMEMB;
+      return (Cache::write(ix, buf, nmemb));
+    }
+
+    /**
+     * Invalidate shadow; the next write transfers the whole
+     * member. Use when the storage block is modified by other means.
+     */
+    void invalidate() final
+    {
+      m_ix = NMEMB;
+    }
+
+    /**
+     * Returns number of bytes not written as unmodified.
+     * @return number of bytes.
+     */
+    uint32_t skipped()
+    {
+      return (m_skipped);
+    }
+
+  protected:
+    /** Shadow buffer; member image in storage. */
+    uint8_t* m_shadow;
+
+    /** Index of shadowed member, NMEMB if none. */
+    size_t m_ix;
+
+    /** Number of bytes not written. */
+    uint32_t m_skipped;
+  };
+
+  /**
+   * Storage Cache with sequential read-ahead. When two consecutive
+   * member reads step in the same direction the following members
+   * (or preceding for a backward scan) are read to the read-ahead
+   * buffer with a single storage transaction and the next reads are
+   * served from the buffer. The buffer is dropped on a read outside
+   * the buffer or a write. Scans with read(ix) are coalesced into
+   * bulk transfers without changes to the loop; only the cache
+   * declaration adds the read-ahead buffer and depth.
+   */
+  class ReadAheadCache : public Cache {
+  public:
+    /**
+     * Construct cached block with read-ahead on given storage device
+     * with the given local buffer, read-ahead buffer and depth, member
+     * size and number of members.
+     * @param[in] mem storage device for block.
+     * @param[in] buf buffer address.
+     * @param[in] ahead read-ahead buffer address (depth members).
+     * @param[in] depth max number of members in read-ahead buffer.
+     * @param[in] size number of bytes per member.
+     * @param[in] nmemb number of members (default 1).
+     */
+    ReadAheadCache(Storage &mem, void* buf, void* ahead, size_t depth,
+		   size_t size, size_t nmemb = 1) :
+      Cache(mem, buf, size, nmemb),
+      DEPTH(depth),
+      m_ahead((uint8_t*) ahead),
+      m_first(0),
+      m_count(0),
+      m_last(nmemb),
+      m_dir(0)
+    {
+    }
+
+    using Cache::read;
+    using Cache::write;
+
+    /**
+     * Read indexed member to buffer, through the read-ahead buffer
+     * when the reads are sequential. Returns number of bytes read or
+     * negative error code.
+     * @param[in] ix member index (default 0):
+     * @return number of bytes read or negative error code.
+     */
+    int read(size_t ix = 0) final
+    {
+      if (ix >= NMEMB) return (-1);
+      int8_t dir = 0;
+      if (m_last < NMEMB) {
+	if (ix == m_last + 1) dir = 1;
+	else if (ix + 1 == m_last) dir = -1;
+      }
+      m_last = ix;
+      if ((ix < m_first) || (ix >= m_first + m_count)) {
+	m_count = 0;
+	if ((dir == 0) || (dir != m_dir) || (DEPTH < 2)) {
+	  m_dir = dir;
+	  return (m_mem.read(m_buf, m_addr + (ix * MSIZE), MSIZE));
+	}
+	size_t first = ix;
+	size_t count = NMEMB - ix;
+	if (dir < 0) {
+	  first = (ix < DEPTH ? 0 : ix + 1 - DEPTH);
+	  count = ix + 1 - first;
+	}
+	if (count > DEPTH) count = DEPTH;
+	if (m_mem.read(m_ahead, m_addr + (first * MSIZE), count * MSIZE) < 0)
+	  return (-1);
+	m_first = first;
+	m_count = count;
+      }
+      m_dir = dir;
+      memcpy(m_buf, m_ahead + ((ix - m_first) * MSIZE), MSIZE);
+      return (MSIZE);
+    }
+
+    /**
+     * Write buffer to indexed storage block and drop the read-ahead
+     * buffer. Returns number of bytes written or negative error code.
+     * @param[in] ix member index (default 0):
+     * @return number of bytes written or negative error code.
+     */
+    int write(size_t ix = 0) final
+    {
+      m_count = 0;
+      return (Cache::write(ix));
+    }
+
+    /**
+     * Write given number of consecutive members, starting with the
+     * indexed member, from the given buffer in a single storage
+     * transaction and drop the read-ahead buffer. Returns number of
+     * bytes written or negative error code.
+     * @param[in] ix index of first member.
+     * @param[in] buf buffer pointer (nmemb members).
+     * @param[in] nmemb number of members.
+     * @return number of bytes written or negative error code.
+     */
+    int write(size_t ix, const void* buf, size_t nmemb) final
+    {
+      m_count = 0;
+      return (Cache::write(ix, buf, nmemb));
+    }
+
+    /**
+     * Drop read-ahead buffer. Use when the storage block is modified
+     * by other means.
+     */
+    void invalidate() final
+    {
+      m_count = 0;
+    }
+
+    /** Max number of members in read-ahead buffer. */
+    const size_t DEPTH;
+
+  protected:
+    /** Read-ahead buffer. */
+    uint8_t* m_ahead;
+
+    /** Index of first member in read-ahead buffer. */
+    size_t m_first;
+
+    /** Number of members in read-ahead buffer. */
+    size_t m_count;
+
+    /** Index of last member read, NMEMB if none. */
+    size_t m_last;
+
+    /** Last read step; forward(1), backward(-1) or none(0). */
+    int8_t m_dir;
+  };
+
+  /**
+   * Stream of given size on given storage. Write/print intermediate
+   * data to the stream that may later be read and transfered.
+   * Multiple stream may be created on the same device. Optional
+   * local buffers stage written bytes and read blocks so that byte
+   * access is coalesced into block device transactions.
+   */
+  class Stream : public ::Stream {
+  public:
+    /**
+     * Construct stream on given storage device with the given size.
+     * @param[in] mem storage device for stream.
+     * @param[in] size number of bytes in stream.
+     */
+    Stream(Storage &mem, size_t size) :
+      SIZE(size),
+      BUF_MAX(0),
+      m_mem(mem),
+      m_addr(m_mem.alloc(size)),
+      m_put(0),
+      m_get(0),
+      m_count(0),
+      m_wbuf(NULL),
+      m_wlen(0),
+      m_wmax(0),
+      m_rbuf(NULL),
+      m_rpos(0),
+      m_rlen(0)
+    {
+    }
+
+    /**
+     * Construct buffered stream on given storage device with the
+     * given size, local put and get buffers, and buffer size. Written
+     * bytes are staged in the put buffer and written to storage in
+     * blocks aligned to the buffer size (e.g. device page size). Read
+     * bytes are fetched in blocks to the get buffer. Either buffer
+     * may be NULL.
+     * @param[in] mem storage device for stream.
+     * @param[in] size number of bytes in stream.
+     * @param[in] put_buf buffer for written bytes (or NULL).
+     * @param[in] get_buf buffer for read bytes (or NULL).
+     * @param[in] buf_max number of bytes per buffer.
+     */
+    Stream(Storage &mem, size_t size,
+	   void* put_buf, void* get_buf, size_t buf_max) :
+      SIZE(size),
+      BUF_MAX(buf_max),
+      m_mem(mem),
+      m_addr(m_mem.alloc(size)),
+      m_put(0),
+      m_get(0),
+      m_count(0),
+      m_wbuf((uint8_t*) put_buf),
+      m_wlen(0),
+      m_wmax(0),
+      m_rbuf((uint8_t*) get_buf),
+      m_rpos(0),
+      m_rlen(0)
+    {
+      align();
+    }
+
+    /**
+     * Destruct stream and free allocated memory on storage device.
+     */
+    ~Stream()
+    {
+      m_mem.free(m_addr, SIZE);
+    }
+
+    /**
+     * Returns storage address for stream.
+     * @return address.
+     */
+    uint32_t addr()
+    {
+      return (m_addr);
+    }
+
+    /**
+     * @override{Stream}
+     * Write given byte to stream. Return number of bytes written,
+     * zero if full.
+     * @param[in] byte to write.
+     * @return number of bytes written(1).
+     */
+    virtual size_t write(uint8_t byte)
+    {
+      if (available() == (int) SIZE) return (0);
+      if (m_wbuf != NULL) {
+	m_wbuf[m_wlen++] = byte;
+	if (m_wlen == m_wmax) sync();
+	return (sizeof(byte));
+      }
+      m_mem.write(m_addr + m_put, &byte, sizeof(byte));
+      m_count += 1;
+      m_put += 1;
+      if (m_put == SIZE) m_put = 0;
+      return (sizeof(byte));
+    }
+
+    /**
+     * @override{Stream}
+     * Write given buffer and number of bytes to stream. Return number
+     * of bytes written, or zero if stream is full.
+     * @param[in] buffer to write.
+     * @param[in] size number of byets to write.
+     * @return number of bytes.
+     */
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+      uint16_t room = SIZE - available();
+      if (room == 0) return (0);
+      if (size > room) size = room;
+      if (m_wbuf == NULL) return (put(buffer, size));
+      size_t res = size;
+      while (size != 0) {
+	size_t n = m_wmax - m_wlen;
+	if (n > size) n = size;
+	memcpy(m_wbuf + m_wlen, buffer, n);
+	m_wlen += n;
+	buffer += n;
+	size -= n;
+	if (m_wlen == m_wmax) sync();
+      }
+      return (res);
     }
 
     /**
@@ -328,7 +2149,7 @@ public:
      */
     virtual int available()
     {
-      return (m_count);
+      return (m_count + m_wlen + (m_rlen - m_rpos));
     }
 
     /**
@@ -339,6 +2160,11 @@ public:
      */
     virtual int peek()
     {
+      if (m_rbuf != NULL) {
+	if ((m_rpos == m_rlen) && (fill() == 0)) return (-1);
+	return (m_rbuf[m_rpos]);
+      }
+      if (m_count == 0) sync();
       if (m_count == 0) return (-1);
       uint8_t res = 0;
       m_mem.read(&res, m_addr + m_get, sizeof(res));
@@ -353,6 +2179,11 @@ public:
      */
     virtual int read()
     {
+      if (m_rbuf != NULL) {
+	if ((m_rpos == m_rlen) && (fill() == 0)) return (-1);
+	return (m_rbuf[m_rpos++]);
+      }
+      if (m_count == 0) sync();
       if (m_count == 0) return (-1);
       uint8_t res = 0;
       m_mem.read(&res, m_addr + m_get, sizeof(res));
@@ -362,6 +2193,139 @@ public:
       return (res);
     }
 
+    /**
+     * Read given number of bytes from stream to buffer. The read is
+     * split at the end of the stream. Return number of bytes read,
+     * zero if empty.
+     * @param[in] buffer to read into.
+     * @param[in] size max number of bytes to read.
+     * @return number of bytes.
+     */
+    size_t read(uint8_t* buffer, size_t size)
+    {
+      size_t res = available();
+      if (size > res) size = res;
+      res = size;
+      size_t n = m_rlen - m_rpos;
+      if (n > size) n = size;
+      if (n != 0) {
+	memcpy(buffer, m_rbuf + m_rpos, n);
+	m_rpos += n;
+	buffer += n;
+	size -= n;
+      }
+      if (size == 0) return (res);
+      if (m_count < size) sync();
+      get(buffer, m_get, size);
+      m_get += size;
+      if (m_get >= SIZE) m_get -= SIZE;
+      m_count -= size;
+      return (res);
+    }
+
+    /**
+     * Read given number of bytes from stream to buffer. Return number
+     * of bytes read. Hides, does not override, ::Stream::readBytes()
+     * which is not virtual; a call through ::Stream reads byte by byte.
+     * @param[in] buffer to read into.
+     * @param[in] length max number of bytes to read.
+     * @return number of bytes.
+     */
+    size_t readBytes(char* buffer, size_t length)
+    {
+      return (read((uint8_t*) buffer, length));
+    }
+
+    /**
+     * Read given number of bytes from stream to buffer. Return number
+     * of bytes read. Hides, does not override, ::Stream::readBytes()
+     * which is not virtual; a call through ::Stream reads byte by byte.
+     * @param[in] buffer to read into.
+     * @param[in] length max number of bytes to read.
+     * @return number of bytes.
+     */
+    size_t readBytes(uint8_t* buffer, size_t length)
+    {
+      return (read(buffer, length));
+    }
+
+    /**
+     * Copy given number of bytes from stream to buffer without
+     * removing. Return number of bytes copied, zero if empty.
+     * @param[in] buffer to copy into.
+     * @param[in] size max number of bytes to copy.
+     * @return number of bytes.
+     */
+    size_t peek(uint8_t* buffer, size_t size)
+    {
+      size_t res = available();
+      if (size > res) size = res;
+      res = size;
+      size_t n = m_rlen - m_rpos;
+      if (n > size) n = size;
+      if (n != 0) {
+	memcpy(buffer, m_rbuf + m_rpos, n);
+	buffer += n;
+	size -= n;
+      }
+      n = m_count;
+      if (n > size) n = size;
+      if (n != 0) {
+	get(buffer, m_get, n);
+	buffer += n;
+	size -= n;
+      }
+      if (size != 0) memcpy(buffer, m_wbuf, size);
+      return (res);
+    }
+
+    /**
+     * Move bytes from given stream to this stream through the given
+     * bounce buffer until the source stream is empty or this stream
+     * is full. Each chunk is moved with a bulk read and write. Return
+     * number of bytes moved.
+     * @param[in] stream source stream.
+     * @param[in] buf bounce buffer pointer.
+     * @param[in] size number of bytes in bounce buffer.
+     * @return number of bytes.
+     */
+    size_t transfer(Stream& stream, void* buf, size_t size)
+    {
+      size_t res = 0;
+      while (1) {
+	size_t n = SIZE - available();
+	if (n > size) n = size;
+	n = stream.read((uint8_t*) buf, n);
+	if (n == 0) break;
+	write((const uint8_t*) buf, n);
+	res += n;
+      }
+      return (res);
+    }
+
+    /**
+     * Remove given number of bytes from stream. Return number of
+     * bytes removed.
+     * @param[in] size max number of bytes to remove.
+     * @return number of bytes.
+     */
+    size_t skip(size_t size)
+    {
+      size_t res = available();
+      if (size > res) size = res;
+      res = size;
+      size_t n = m_rlen - m_rpos;
+      if (n > size) n = size;
+      m_rpos += n;
+      size -= n;
+      if (size == 0) return (res);
+      if (m_count < size) sync();
+      m_get += size;
+      if (m_get >= SIZE) m_get -= SIZE;
+      m_count -= size;
+      return (res);
+    }
+
     /**
      * @override{Stream}
      * Flush all data and reset stream.
@@ -371,11 +2335,32 @@ public:
       m_put = 0;
       m_get = 0;
       m_count = 0;
+      m_wlen = 0;
+      m_rpos = 0;
+      m_rlen = 0;
+      align();
+    }
+
+    /**
+     * Write bytes staged in the put buffer to storage. Returns number
+     * of bytes written or negative error code.
+     * @return number of bytes written or negative error code.
+     */
+    int sync()
+    {
+      if (m_wlen == 0) return (0);
+      int res = put(m_wbuf, m_wlen);
+      m_wlen = 0;
+      align();
+      return (res);
     }
 
     /** Total size of the stream. */
     size_t SIZE;
 
+    /** Size of put and get buffers. */
+    const size_t BUF_MAX;
+
   protected:
     /** Storage device for the stream. */
     Storage& m_mem;
@@ -391,10 +2376,154 @@ public:
 
     /** Number of bytes available. */
     uint16_t m_count;
+
+    /** Put buffer for staged bytes (or NULL). */
+    uint8_t* m_wbuf;
+
+    /** Number of bytes in put buffer. */
+    uint16_t m_wlen;
+
+    /** Number of bytes to stage before write to storage. */
+    uint16_t m_wmax;
+
+    /** Get buffer for fetched bytes (or NULL). */
+    uint8_t* m_rbuf;
+
+    /** Index of next byte in get buffer. */
+    uint16_t m_rpos;
+
+    /** Number of bytes in get buffer. */
+    uint16_t m_rlen;
+
+    /**
+     * Write given buffer and number of bytes to storage at the put
+     * index. Splits the write at the end of the stream. The caller
+     * must check that there is room for the bytes. Return number of
+     * bytes written.
+     * @param[in] buffer to write.
+     * @param[in] size number of byets to write.
+     * @return number of bytes.
+     */
+    size_t put(const uint8_t *buffer, size_t size)
+    {
+      size_t res = size;
+      uint16_t room = SIZE - m_put;
+      if (size > room) {
+	m_mem.write(m_addr + m_put, buffer, room);
+	buffer += room;
+	size -= room;
+	m_count += room;
+	m_put = 0;
+      }
+      m_mem.write(m_addr + m_put, buffer, size);
+      m_count += size;
+      m_put += size;
+      if (m_put == SIZE) m_put = 0;
+      return (res);
+    }
+
+    /**
+     * Read given number of bytes from storage at the given index to
+     * buffer. Splits the read at the end of the stream. The caller
+     * must check that the bytes are available.
+     * @param[in] buffer to read into.
+     * @param[in] pos stream index of first byte.
+     * @param[in] size number of bytes to read.
+     */
+    void get(uint8_t* buffer, uint16_t pos, size_t size)
+    {
+      uint16_t room = SIZE - pos;
+      if (size > room) {
+	m_mem.read(buffer, m_addr + pos, room);
+	buffer += room;
+	size -= room;
+	pos = 0;
+      }
+      m_mem.read(buffer, m_addr + pos, size);
+    }
+
+    /**
+     * Fetch next block of bytes from storage to the get buffer. Bytes
+     * staged in the put buffer are written first if needed. Returns
+     * number of bytes fetched.
+     * @return number of bytes.
+     */
+    size_t fill()
+    {
+      if (m_count == 0) sync();
+      if (m_count == 0) return (0);
+      size_t n = SIZE - m_get;
+      if (n > m_count) n = m_count;
+      if (n > BUF_MAX) n = BUF_MAX;
+      m_mem.read(m_rbuf, m_addr + m_get, n);
+      m_count -= n;
+      m_get += n;
+      if (m_get == SIZE) m_get = 0;
+      m_rpos = 0;
+      m_rlen = n;
+      return (n);
+    }
+
+    /**
+     * Calculate number of bytes to stage in put buffer so that the
+     * storage write ends on a buffer size aligned address or the end
+     * of the stream.
+     */
+    void align()
+    {
+      if (m_wbuf == NULL) return;
+      m_wmax = BUF_MAX - ((m_addr + m_put) % BUF_MAX);
+      if (m_wmax > SIZE - m_put) m_wmax = SIZE - m_put;
+    }
   };
 
 protected:
   /** Address of the next allocation. */
   uint32_t m_addr;
+
+  /** Number of bytes dropped when the free extent table was full. */
+  uint32_t m_leaked;
+
+#if STORAGE_FREE_MAX > 0
+  /** Free extent on storage. */
+  struct extent_t {
+    uint32_t addr;		//!< Address of free extent.
+    uint32_t size;		//!< Number of bytes.
+  };
+
+  /** Free extents below the allocation point in address order. */
+  extent_t m_free[STORAGE_FREE_MAX];
+
+  /** Number of free extents. */
+  uint8_t m_fragments;
+
+  /**
+   * Remove free extent with given index.
+   * @param[in] ix extent index.
+   */
+  void remove(uint8_t ix)
+  {
+    m_fragments -= 1;
+    for (uint8_t i = ix; i < m_fragments; i++) m_free[i] = m_free[i + 1];
+  }
+
+  /**
+   * Coalesce last free extent with the allocation point.
+   */
+  void top()
+  {
+    if (m_fragments == 0) return;
+    extent_t& last = m_free[m_fragments - 1];
+    if (last.addr + last.size != m_addr) return;
+    m_addr = last.addr;
+    m_fragments -= 1;
+  }
+#endif
 };
+
+template<typename T, size_t N>
+constexpr size_t Storage::Vector<T, N>::MSIZE;
+
+template<typename T, size_t N>
+constexpr size_t Storage::Vector<T, N>::NMEMB;
 #endif